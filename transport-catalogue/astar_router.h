@@ -0,0 +1,360 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "shortest_path_tree.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Нижняя оценка веса пути из первой вершины во вторую. Оценка должна быть допустимой
+// (не больше веса кратчайшего пути), а для двунаправленного поиска ещё и согласованной:
+// lower_bound(u, t) ≤ weight(u → v) + lower_bound(v, t) для любого ребра u → v
+template <typename Weight>
+using LowerBound = std::function<Weight(VertexId from, VertexId to)>;
+
+enum class AStarMode {
+    UNIDIRECTIONAL,
+    // Встречный поиск со средними потенциалами (h(v, to) − h(from, v)) / 2
+    BIDIRECTIONAL,
+};
+
+// Поиск по требованию, направленный к цели нижней оценкой расстояния (A*).
+// Ничего не предрасчитывает; считает вершины, извлечённые из очереди за запрос.
+template <typename Weight>
+class AStarRouter final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+
+    AStarRouter(const Graph& graph, LowerBound<Weight> lower_bound, AStarMode mode = AStarMode::UNIDIRECTIONAL);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const override;
+
+    std::vector<std::optional<Weight>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                         const std::vector<VertexId>& targets) const override;
+
+    size_t GetMemoryUsage() const override;
+
+    void PrintStats(std::ostream& output) const override;
+
+    size_t GetQueryCount() const;
+    size_t GetLastSettledCount() const;
+    size_t GetTotalSettledCount() const;
+
+private:
+    // Начиная с этого числа целей из одного источника полный проход Дейкстры дешевле отдельных поисков
+    static constexpr size_t MIN_TREE_TARGETS = 4;
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHED_WEIGHT = std::numeric_limits<Weight>::max();
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    // Состояние одного направления поиска; потенциал вершины вычисляется один раз,
+    // когда она впервые достигнута
+    struct SearchSpace {
+        std::vector<Weight> weights;
+        std::vector<Weight> potentials;
+        std::vector<EdgeId> parent_edges;
+        std::vector<VertexId> touched;
+
+        explicit SearchSpace(size_t vertex_count = 0)
+            : weights(vertex_count, UNREACHED_WEIGHT)
+            , potentials(vertex_count, ZERO_WEIGHT)
+            , parent_edges(vertex_count, NO_EDGE) {
+        }
+
+        template <typename Potential>
+        void Set(VertexId vertex, Weight weight, EdgeId parent_edge, const Potential& potential) {
+            if (weights[vertex] == UNREACHED_WEIGHT) {
+                touched.push_back(vertex);
+                potentials[vertex] = potential(vertex);
+            }
+            weights[vertex] = weight;
+            parent_edges[vertex] = parent_edge;
+        }
+
+        void Reset() {
+            for (const VertexId vertex : touched) {
+                weights[vertex] = UNREACHED_WEIGHT;
+                parent_edges[vertex] = NO_EDGE;
+            }
+            touched.clear();
+        }
+    };
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    std::optional<RouteInfo> SearchUnidirectional(VertexId from, VertexId to) const {
+        SearchSpace& space = forward_space_;
+        space.Reset();
+        const auto potential = [&](VertexId vertex) {
+            return lower_bound_(vertex, to);
+        };
+        Queue queue;
+        space.Set(from, ZERO_WEIGHT, NO_EDGE, potential);
+        queue.push({space.potentials[from], from});
+
+        while (!queue.empty()) {
+            const auto [key, vertex] = queue.top();
+            queue.pop();
+            // Устаревшая запись: вершина уже извлекалась с меньшим весом
+            if (key > space.weights[vertex] + space.potentials[vertex]) {
+                continue;
+            }
+            ++last_settled_count_;
+            if (vertex == to) {
+                std::vector<EdgeId> edges;
+                AppendPath(space, to, edges, true);
+                std::reverse(edges.begin(), edges.end());
+                return RouteInfo{space.weights[to], std::move(edges)};
+            }
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const Weight candidate_weight = space.weights[vertex] + edge.weight;
+                if (candidate_weight < space.weights[edge.to]) {
+                    space.Set(edge.to, candidate_weight, edge_id, potential);
+                    queue.push({candidate_weight + space.potentials[edge.to], edge.to});
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<RouteInfo> SearchBidirectional(VertexId from, VertexId to) const {
+        forward_space_.Reset();
+        backward_space_.Reset();
+        // Потенциал обратного поиска противоположен прямому, поэтому приведённые
+        // веса рёбер в обоих направлениях совпадают
+        const auto forward_potential = [&](VertexId vertex) {
+            return (lower_bound_(vertex, to) - lower_bound_(from, vertex)) / 2;
+        };
+        const auto backward_potential = [&](VertexId vertex) {
+            return -forward_potential(vertex);
+        };
+
+        Queue forward_queue;
+        Queue backward_queue;
+        forward_space_.Set(from, ZERO_WEIGHT, NO_EDGE, forward_potential);
+        forward_queue.push({forward_space_.potentials[from], from});
+        backward_space_.Set(to, ZERO_WEIGHT, NO_EDGE, backward_potential);
+        backward_queue.push({backward_space_.potentials[to], to});
+
+        Weight best_weight = UNREACHED_WEIGHT;
+        VertexId meeting_vertex = from;
+        const auto update_best = [&](VertexId vertex) {
+            if (forward_space_.weights[vertex] == UNREACHED_WEIGHT
+                || backward_space_.weights[vertex] == UNREACHED_WEIGHT) {
+                return;
+            }
+            const Weight weight = forward_space_.weights[vertex] + backward_space_.weights[vertex];
+            if (weight < best_weight) {
+                best_weight = weight;
+                meeting_vertex = vertex;
+            }
+        };
+        update_best(from);
+
+        // Если одна из очередей опустела, все достижимые с её стороны вершины обработаны
+        while (!forward_queue.empty() && !backward_queue.empty()) {
+            const Weight forward_key = forward_queue.top().first;
+            const Weight backward_key = backward_queue.top().first;
+            // Сумма ключей — нижняя граница любого ещё не найденного пути
+            if (best_weight != UNREACHED_WEIGHT && forward_key + backward_key >= best_weight) {
+                break;
+            }
+            if (forward_key <= backward_key) {
+                SearchStep(forward_queue, forward_space_, forward_potential, false, update_best);
+            } else {
+                SearchStep(backward_queue, backward_space_, backward_potential, true, update_best);
+            }
+        }
+
+        if (best_weight == UNREACHED_WEIGHT) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        AppendPath(forward_space_, meeting_vertex, edges, true);
+        std::reverse(edges.begin(), edges.end());
+        AppendPath(backward_space_, meeting_vertex, edges, false);
+        return RouteInfo{best_weight, std::move(edges)};
+    }
+
+    template <typename Potential, typename UpdateBest>
+    void SearchStep(Queue& queue, SearchSpace& space, const Potential& potential, bool backward,
+                    const UpdateBest& update_best) const {
+        const auto [key, vertex] = queue.top();
+        queue.pop();
+        if (key > space.weights[vertex] + space.potentials[vertex]) {
+            return;
+        }
+        ++last_settled_count_;
+        const auto relax = [&](EdgeId edge_id, VertexId next) {
+            const Weight candidate_weight = space.weights[vertex] + graph_.GetEdge(edge_id).weight;
+            if (candidate_weight < space.weights[next]) {
+                space.Set(next, candidate_weight, edge_id, potential);
+                queue.push({candidate_weight + space.potentials[next], next});
+                update_best(next);
+            }
+        };
+        if (backward) {
+            for (size_t i = reverse_offsets_[vertex]; i < reverse_offsets_[vertex + 1]; ++i) {
+                relax(reverse_edges_[i], graph_.GetEdge(reverse_edges_[i]).from);
+            }
+        } else {
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                relax(edge_id, graph_.GetEdge(edge_id).to);
+            }
+        }
+    }
+
+    // Добавляет рёбра дерева поиска от vertex к корню: для прямого поиска — в обратном порядке
+    void AppendPath(const SearchSpace& space, VertexId vertex, std::vector<EdgeId>& edges, bool forward) const {
+        for (EdgeId edge_id = space.parent_edges[vertex]; edge_id != NO_EDGE;) {
+            edges.push_back(edge_id);
+            const auto& edge = graph_.GetEdge(edge_id);
+            edge_id = space.parent_edges[forward ? edge.from : edge.to];
+        }
+    }
+
+    const Graph& graph_;
+    LowerBound<Weight> lower_bound_;
+    AStarMode mode_;
+    // Входящие рёбра вершин для обратного поиска (CSR)
+    std::vector<size_t> reverse_offsets_;
+    std::vector<EdgeId> reverse_edges_;
+
+    mutable SearchSpace forward_space_;
+    mutable SearchSpace backward_space_;
+    mutable size_t query_count_ = 0;
+    mutable size_t last_settled_count_ = 0;
+    mutable size_t total_settled_count_ = 0;
+    // Полные деревья, построенные для пакетов запросов из одного источника
+    mutable size_t tree_count_ = 0;
+};
+
+template <typename Weight>
+AStarRouter<Weight>::AStarRouter(const Graph& graph, LowerBound<Weight> lower_bound, AStarMode mode)
+    : graph_(graph)
+    , lower_bound_(std::move(lower_bound))
+    , mode_(mode)
+    , forward_space_(graph.GetVertexCount())
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    if (mode_ != AStarMode::BIDIRECTIONAL) {
+        return;
+    }
+
+    backward_space_ = SearchSpace(vertex_count);
+    reverse_offsets_.assign(vertex_count + 1, 0);
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        ++reverse_offsets_[graph.GetEdge(edge_id).to + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        reverse_offsets_[vertex + 1] += reverse_offsets_[vertex];
+    }
+    reverse_edges_.resize(graph.GetEdgeCount());
+    std::vector<size_t> next_position(reverse_offsets_.begin(), reverse_offsets_.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        reverse_edges_[next_position[graph.GetEdge(edge_id).to]++] = edge_id;
+    }
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo> AStarRouter<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+    ++query_count_;
+    last_settled_count_ = 0;
+    auto route = mode_ == AStarMode::BIDIRECTIONAL ? SearchBidirectional(from, to) : SearchUnidirectional(from, to);
+    total_settled_count_ += last_settled_count_;
+    return route;
+}
+
+template <typename Weight>
+std::vector<std::optional<typename AStarRouter<Weight>::RouteInfo>> AStarRouter<Weight>::BuildRoutes(
+    VertexId from, const std::vector<VertexId>& targets) const {
+    if (targets.size() < MIN_TREE_TARGETS) {
+        return RoutingEngine<Weight>::BuildRoutes(from, targets);
+    }
+    const ShortestPathTree<Weight> tree = BuildShortestPathTree(graph_, from);
+    ++tree_count_;
+    std::vector<std::optional<RouteInfo>> routes;
+    routes.reserve(targets.size());
+    for (const VertexId to : targets) {
+        routes.push_back(ExtractRoute(graph_, tree, to));
+    }
+    return routes;
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> AStarRouter<Weight>::BuildWeightMatrix(
+    const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+    if (targets.size() < MIN_TREE_TARGETS) {
+        return RoutingEngine<Weight>::BuildWeightMatrix(sources, targets);
+    }
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(sources.size() * targets.size());
+    for (const VertexId from : sources) {
+        AppendTreeWeights(BuildShortestPathTree(graph_, from), targets, weights);
+        ++tree_count_;
+    }
+    return weights;
+}
+
+template <typename Weight>
+size_t AStarRouter<Weight>::GetMemoryUsage() const {
+    const auto space_memory = [](const SearchSpace& space) {
+        return space.weights.capacity() * sizeof(Weight) + space.potentials.capacity() * sizeof(Weight)
+             + space.parent_edges.capacity() * sizeof(EdgeId) + space.touched.capacity() * sizeof(VertexId);
+    };
+    return space_memory(forward_space_) + space_memory(backward_space_)
+         + reverse_offsets_.capacity() * sizeof(size_t) + reverse_edges_.capacity() * sizeof(EdgeId);
+}
+
+template <typename Weight>
+void AStarRouter<Weight>::PrintStats(std::ostream& output) const {
+    output << "astar: mode=" << (mode_ == AStarMode::BIDIRECTIONAL ? "bidirectional" : "unidirectional")
+           << " queries=" << query_count_
+           << " settled=" << total_settled_count_
+           << " avg_settled=" << (query_count_ == 0 ? 0.0 : static_cast<double>(total_settled_count_) / query_count_)
+           << " trees=" << tree_count_
+           << std::endl;
+}
+
+template <typename Weight>
+size_t AStarRouter<Weight>::GetQueryCount() const {
+    return query_count_;
+}
+
+template <typename Weight>
+size_t AStarRouter<Weight>::GetLastSettledCount() const {
+    return last_settled_count_;
+}
+
+template <typename Weight>
+size_t AStarRouter<Weight>::GetTotalSettledCount() const {
+    return total_settled_count_;
+}
+
+}  // namespace graph
@@ -0,0 +1,162 @@
+// Бенчмарк чтения каталога: изменяемые таблицы, замороженный снимок в памяти и снимок,
+// отображённый из файла (режим import-snapshot). На синтетическом каталоге со случайными
+// дорожными расстояниями измеряются поиск остановки по имени, автобусы остановки по имени,
+// дорожное расстояние между двумя остановками по id и обход всех автобусов.
+// Поиски идут в случайном порядке, чтобы промахи кэша были как на настоящих запросах.
+//
+// Запуск: catalogue_benchmark [число остановок [число автобусов]], по умолчанию 500000 25000
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "transport_catalogue.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t LOOKUP_COUNT = 2'000'000;
+constexpr int SCAN_REPEAT_COUNT = 5;
+
+// Остановки на случайных координатах, у каждой до четырёх заданных расстояний,
+// автобусы проходят от 3 до 25 случайных остановок, половина — кольцевые
+void FillCatalogue(catalogue::TransportCatalogue& catalogue, const std::vector<std::string>& stop_names,
+                   size_t bus_count, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> lat_distribution(55.5, 56.0);
+    std::uniform_real_distribution<double> lng_distribution(37.3, 37.9);
+    std::uniform_int_distribution<size_t> stop_distribution(0, stop_names.size() - 1);
+    std::uniform_int_distribution<size_t> distance_count_distribution(0, 4);
+    std::uniform_int_distribution<int> distance_distribution(300, 5000);
+    std::uniform_int_distribution<size_t> bus_stop_count_distribution(3, 25);
+    std::bernoulli_distribution roundtrip_distribution(0.5);
+
+    for (const std::string& name : stop_names) {
+        catalogue.AddStop({name, {lat_distribution(random), lng_distribution(random)}});
+    }
+    for (const std::string& name : stop_names) {
+        for (size_t i = distance_count_distribution(random); i > 0; --i) {
+            catalogue.AddDistance(name, stop_names[stop_distribution(random)], distance_distribution(random));
+        }
+    }
+    for (size_t bus = 0; bus < bus_count; ++bus) {
+        std::vector<std::string_view> stops;
+        for (size_t i = bus_stop_count_distribution(random); i > 0; --i) {
+            stops.push_back(stop_names[stop_distribution(random)]);
+        }
+        const bool is_roundtrip = roundtrip_distribution(random);
+        if (is_roundtrip) {
+            stops.push_back(stops.front());
+        }
+        catalogue.AddBus("Bus " + std::to_string(bus), stops, is_roundtrip);
+    }
+}
+
+// Среднее время одного вызова body(i) на LOOKUP_COUNT вызовах, в наносекундах
+template <typename Body>
+double MeasureNanoseconds(Body body) {
+    uint64_t checksum = 0;
+    const auto start = Clock::now();
+    for (size_t i = 0; i < LOOKUP_COUNT; ++i) {
+        checksum += body(i);
+    }
+    const double nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    // Сумма не даёт компилятору выбросить поиски
+    if (checksum == 1) {
+        std::cerr << checksum;
+    }
+    return nanoseconds / LOOKUP_COUNT;
+}
+
+double MeasureScanMilliseconds(const catalogue::TransportCatalogue& catalogue) {
+    uint64_t checksum = 0;
+    const auto start = Clock::now();
+    for (int repeat = 0; repeat < SCAN_REPEAT_COUNT; ++repeat) {
+        for (const auto& [name, bus] : catalogue.GetAllBuses()) {
+            for (const domain::StopId stop : bus->stops) {
+                checksum += stop;
+            }
+            checksum += static_cast<uint64_t>(bus->stat.route_length);
+        }
+    }
+    const double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    if (checksum == 1) {
+        std::cerr << checksum;
+    }
+    return milliseconds / SCAN_REPEAT_COUNT;
+}
+
+void PrintRow(const std::string& layout, const catalogue::TransportCatalogue& catalogue,
+              const std::vector<std::string>& stop_names, const std::vector<uint32_t>& order) {
+    const size_t stop_count = stop_names.size();
+    const double find_stop = MeasureNanoseconds([&](size_t i) {
+        return catalogue.FindStop(stop_names[order[i % order.size()]])->id;
+    });
+    const double get_stop_info = MeasureNanoseconds([&](size_t i) {
+        return catalogue.GetStopInfo(stop_names[order[i % order.size()]]).size();
+    });
+    const double find_distance = MeasureNanoseconds([&](size_t i) {
+        const uint32_t from = order[i % order.size()];
+        const uint32_t to = order[(i * 7 + 1) % order.size()];
+        return static_cast<uint64_t>(catalogue.FindDistance(from, to));
+    });
+    std::cout << std::setw(9) << layout << std::setw(8) << stop_count << std::fixed << std::setprecision(0)
+              << std::setw(14) << find_stop << std::setw(18) << get_stop_info << std::setw(18) << find_distance
+              << std::setprecision(1) << std::setw(9) << MeasureScanMilliseconds(catalogue)
+              << std::defaultfloat << std::endl;
+}
+
+double MillisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t stop_count = argc > 1 ? std::stoul(argv[1]) : 500'000;
+    const size_t bus_count = argc > 2 ? std::stoul(argv[2]) : 25'000;
+    const std::string snapshot_path = "catalogue_benchmark.snapshot";
+
+    std::vector<std::string> stop_names;
+    for (size_t i = 0; i < stop_count; ++i) {
+        stop_names.push_back("Stop " + std::to_string(i * 2654435761u % 1'000'000'007u));
+    }
+    std::vector<uint32_t> order(stop_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(1));
+
+    std::cout << "   layout   stops  find_stop_ns  get_stop_info_ns  find_distance_ns  scan_ms" << std::endl;
+    catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue, stop_names, bus_count, 1);
+    PrintRow("mutable", catalogue, stop_names, order);
+
+    auto start = Clock::now();
+    catalogue.Freeze();
+    const double freeze_milliseconds = MillisecondsSince(start);
+    PrintRow("frozen", catalogue, stop_names, order);
+    {
+        std::ofstream output(snapshot_path, std::ios::binary);
+        catalogue.SaveSnapshot(output);
+    }
+
+    start = Clock::now();
+    catalogue::TransportCatalogue imported;
+    imported.LoadSnapshot(snapshot_path);
+    const double load_milliseconds = MillisecondsSince(start);
+    PrintRow("imported", imported, stop_names, order);
+    std::remove(snapshot_path.c_str());
+
+    std::cout << std::fixed << std::setprecision(0) << "freeze " << freeze_milliseconds << " ms, load "
+              << load_milliseconds << " ms, snapshot " << catalogue.GetSnapshotMemoryUsage() / (1 << 20) << " MB"
+              << std::endl;
+    return 0;
+}
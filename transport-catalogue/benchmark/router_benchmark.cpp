@@ -0,0 +1,186 @@
+// Бенчмарк предрасчёта всех пар (graph::Router) на синтетических транспортных сетях.
+// Ядра CLASSIC и BLOCKED с весами double и float сравниваются с прежним скалярным
+// циклом релаксации, который ветвится на каждой ячейке таблицы. Все варианты считаются
+// в одном потоке, а их таблицы сверяются с эталонной.
+//
+// Запуск: router_benchmark [число остановок ...], по умолчанию 1000 2000 5000
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "router.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Graph = graph::DirectedWeightedGraph<double>;
+
+constexpr double INFINITE_WEIGHT = std::numeric_limits<double>::infinity();
+constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+// Сеть как в полной модели графа маршрутов: вершина — остановка, ребро — поездка
+// одним автобусом между любыми двумя его остановками, вес — ожидание плюс время в пути.
+// Автобусов в пять раз меньше, чем остановок, в каждом от 3 до 25 остановок,
+// половина — кольцевые, перегоны от 300 до 5000 метров
+Graph MakeNetwork(size_t stop_count, uint32_t seed) {
+    constexpr double BUS_WAIT_TIME = 6.0;
+    constexpr double METERS_PER_MINUTE = 40.0 * 1000.0 / 60.0;
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<size_t> stop_count_distribution(3, 25);
+    std::uniform_int_distribution<int> distance_distribution(300, 5000);
+    std::bernoulli_distribution roundtrip_distribution(0.5);
+
+    std::vector<uint32_t> stops(stop_count);
+    std::iota(stops.begin(), stops.end(), 0);
+    Graph graph(stop_count);
+    const size_t bus_count = stop_count / 5;
+    for (uint32_t bus = 0; bus < bus_count; ++bus) {
+        // Частичное перемешивание выбирает различные остановки автобуса
+        const size_t bus_stop_count = std::min(stop_count_distribution(random), stop_count);
+        for (size_t i = 0; i < bus_stop_count; ++i) {
+            std::swap(stops[i], stops[std::uniform_int_distribution<size_t>(i, stop_count - 1)(random)]);
+        }
+        std::vector<uint32_t> route(stops.begin(), stops.begin() + bus_stop_count);
+        if (roundtrip_distribution(random)) {
+            route.push_back(route.front());
+        } else {
+            route.insert(route.end(), route.rbegin() + 1, route.rend());
+        }
+
+        std::vector<double> distances{0.0};
+        for (size_t i = 1; i < route.size(); ++i) {
+            distances.push_back(distances.back() + distance_distribution(random));
+        }
+        for (size_t i = 0; i < route.size(); ++i) {
+            for (size_t j = i + 1; j < route.size(); ++j) {
+                const double weight = BUS_WAIT_TIME + (distances[j] - distances[i]) / METERS_PER_MINUTE;
+                graph.AddEdge({route[i], route[j], weight, bus, static_cast<uint16_t>(j - i)});
+            }
+        }
+    }
+    graph.Freeze();
+    return graph;
+}
+
+// Прежний цикл релаксации: скалярный, с ветвлением на каждой ячейке
+std::vector<double> RelaxReference(const Graph& graph) {
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<double> weights(vertex_count * vertex_count, INFINITE_WEIGHT);
+    std::vector<uint32_t> prev_edges(vertex_count * vertex_count, NO_EDGE);
+    for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        weights[vertex * vertex_count + vertex] = 0.0;
+        for (const graph::EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.weight < weights[vertex * vertex_count + edge.to]) {
+                weights[vertex * vertex_count + edge.to] = edge.weight;
+                prev_edges[vertex * vertex_count + edge.to] = static_cast<uint32_t>(edge_id);
+            }
+        }
+    }
+    for (size_t through = 0; through < vertex_count; ++through) {
+        const double* weights_through = &weights[through * vertex_count];
+        const uint32_t* prev_edges_through = &prev_edges[through * vertex_count];
+        for (size_t from = 0; from < vertex_count; ++from) {
+            double* weights_from = &weights[from * vertex_count];
+            uint32_t* prev_edges_from = &prev_edges[from * vertex_count];
+            const double weight_from = weights_from[through];
+            if (weight_from == INFINITE_WEIGHT) {
+                continue;
+            }
+            const uint32_t prev_edge_from = prev_edges_from[through];
+            for (size_t to = 0; to < vertex_count; ++to) {
+                const double candidate_weight = weight_from + weights_through[to];
+                if (candidate_weight < weights_from[to]) {
+                    weights_from[to] = candidate_weight;
+                    prev_edges_from[to] = prev_edges_through[to] != NO_EDGE ? prev_edges_through[to] : prev_edge_from;
+                }
+            }
+        }
+    }
+    return weights;
+}
+
+struct Measurement {
+    double milliseconds = 0.0;
+    // Наибольшее относительное отклонение веса от эталона; бесконечность — расхождение в достижимости
+    double max_error = 0.0;
+};
+
+template <typename StoredWeight>
+Measurement MeasureRouter(const Graph& graph, graph::RelaxKernel kernel, const std::vector<double>& reference) {
+    const auto start = Clock::now();
+    const graph::Router<double, StoredWeight> router(graph, 1, kernel);
+    Measurement result{std::chrono::duration<double, std::milli>(Clock::now() - start).count(), 0.0};
+
+    const size_t vertex_count = graph.GetVertexCount();
+    const auto& table = router.GetRouteTable();
+    for (size_t from = 0; from < vertex_count; ++from) {
+        const StoredWeight* weights = table.GetWeights(from);
+        for (size_t to = 0; to < vertex_count; ++to) {
+            const double expected = reference[from * vertex_count + to];
+            const double actual = static_cast<double>(weights[to]);
+            if (std::isinf(expected) || std::isinf(actual)) {
+                if (std::isinf(expected) != std::isinf(actual)) {
+                    result.max_error = INFINITE_WEIGHT;
+                }
+                continue;
+            }
+            result.max_error = std::max(result.max_error, std::abs(actual - expected) / std::max(1.0, expected));
+        }
+    }
+    return result;
+}
+
+void PrintRow(size_t stop_count, size_t edge_count, const std::string& kernel, const std::string& weight,
+              const Measurement& measurement, double reference_milliseconds) {
+    std::cout << std::setw(6) << stop_count << std::setw(9) << edge_count << std::setw(11) << kernel
+              << std::setw(8) << weight << std::fixed << std::setprecision(0) << std::setw(11) << measurement.milliseconds
+              << std::setprecision(2) << std::setw(9) << reference_milliseconds / measurement.milliseconds
+              << std::scientific << std::setprecision(1) << std::setw(11) << measurement.max_error
+              << std::defaultfloat << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> stop_counts;
+    for (int i = 1; i < argc; ++i) {
+        stop_counts.push_back(std::stoul(argv[i]));
+    }
+    if (stop_counts.empty()) {
+        stop_counts = {1000, 2000, 5000};
+    }
+
+    std::cout << " stops    edges     kernel  weight    time_ms  speedup  max_error" << std::endl;
+    for (const size_t stop_count : stop_counts) {
+        const Graph graph = MakeNetwork(stop_count, static_cast<uint32_t>(stop_count));
+        const size_t edge_count = graph.GetEdgeCount();
+
+        auto start = Clock::now();
+        const std::vector<double> reference = RelaxReference(graph);
+        const Measurement reference_measurement{
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count(), 0.0};
+        PrintRow(stop_count, edge_count, "reference", "double", reference_measurement, reference_measurement.milliseconds);
+
+        const double reference_milliseconds = reference_measurement.milliseconds;
+        PrintRow(stop_count, edge_count, "classic", "double",
+                 MeasureRouter<double>(graph, graph::RelaxKernel::CLASSIC, reference), reference_milliseconds);
+        PrintRow(stop_count, edge_count, "blocked", "double",
+                 MeasureRouter<double>(graph, graph::RelaxKernel::BLOCKED, reference), reference_milliseconds);
+        PrintRow(stop_count, edge_count, "classic", "float",
+                 MeasureRouter<float>(graph, graph::RelaxKernel::CLASSIC, reference), reference_milliseconds);
+        PrintRow(stop_count, edge_count, "blocked", "float",
+                 MeasureRouter<float>(graph, graph::RelaxKernel::BLOCKED, reference), reference_milliseconds);
+    }
+    return 0;
+}
@@ -0,0 +1,349 @@
+#include "catalogue_snapshot.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "flat_hash_map.h"
+#include "transport_catalogue.h"
+
+namespace catalogue {
+
+    namespace {
+
+        constexpr char SNAPSHOT_MAGIC[8] = {'T', 'C', 'C', 'A', 'T', 'L', 'O', 'G'};
+        constexpr uint32_t SNAPSHOT_VERSION = 1;
+        constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        // Смещения и размеры внутри снимка хранятся в 32 битах
+        uint32_t CheckOffset(size_t offset) {
+            if (offset > std::numeric_limits<uint32_t>::max()) {
+                throw std::length_error("Catalogue is too large for a snapshot");
+            }
+            return static_cast<uint32_t>(offset);
+        }
+
+        void CheckSnapshot(bool condition) {
+            if (!condition) {
+                throw std::runtime_error("Corrupted catalogue snapshot");
+            }
+        }
+
+        // Смещения вида offsets[i]..offsets[i + 1] на count записей: неубывают и заканчиваются на count
+        void CheckOffsets(ranges::Span<uint32_t> offsets, size_t group_count, size_t count) {
+            CheckSnapshot(offsets.size() == group_count + 1 && offsets.front() == 0 && offsets.back() == count);
+            for (size_t i = 0; i < group_count; ++i) {
+                CheckSnapshot(offsets[i] <= offsets[i + 1]);
+            }
+        }
+
+    }  // namespace
+
+    CatalogueSnapshot::CatalogueSnapshot(const TransportCatalogue& catalogue) {
+        const size_t stop_count = catalogue.GetStopCount();
+        const size_t bus_count = catalogue.GetBusCount();
+
+        // Одинаковые имена (остановка и автобус, заменённые автобусы) хранятся один раз
+        std::string names;
+        containers::FlatHashMap<std::string_view, uint32_t, containers::StringHash> name_offsets;
+        const auto add_name = [&names, &name_offsets](std::string_view name) {
+            if (const uint32_t* offset = name_offsets.Find(name)) {
+                return *offset;
+            }
+            const uint32_t offset = CheckOffset(names.size());
+            CheckOffset(names.size() + name.size());
+            names += name;
+            name_offsets.Insert(name, offset);
+            return offset;
+        };
+
+        std::vector<StopRecord> stops;
+        std::vector<std::string_view> stop_names;
+        stops.reserve(stop_count);
+        stop_names.reserve(stop_count);
+        for (domain::StopId id = 0; id < stop_count; ++id) {
+            const domain::Stop& stop = catalogue.GetStop(id);
+            stops.push_back({add_name(stop.name), static_cast<uint32_t>(stop.name.size()), stop.coord.lat, stop.coord.lng});
+            stop_names.push_back(stop.name);
+        }
+
+        std::vector<BusRecord> buses;
+        std::vector<domain::StopId> bus_stops;
+        std::vector<int> bus_road_distances;
+        std::vector<double> bus_geo_distances;
+        buses.reserve(bus_count);
+        for (domain::BusId id = 0; id < bus_count; ++id) {
+            const domain::Bus& bus = catalogue.GetBus(id);
+            buses.push_back({add_name(bus.name), static_cast<uint32_t>(bus.name.size()),
+                             CheckOffset(bus_stops.size()), static_cast<uint32_t>(bus.stops.size()),
+                             bus.stat.curve, bus.stat.route_length, bus.stat.unique_stop_count,
+                             bus.is_roundtrip ? 1u : 0u, 0});
+            bus_stops.insert(bus_stops.end(), bus.stops.begin(), bus.stops.end());
+            bus_road_distances.insert(bus_road_distances.end(), bus.road_distances.begin(), bus.road_distances.end());
+            bus_geo_distances.insert(bus_geo_distances.end(), bus.geo_distances.begin(), bus.geo_distances.end());
+        }
+        CheckOffset(bus_stops.size());
+
+        std::vector<domain::BusId> sorted_buses;
+        std::vector<std::string_view> bus_names;
+        for (const auto& [name, bus] : catalogue.GetAllBuses()) {
+            sorted_buses.push_back(bus->id);
+            bus_names.push_back(name);
+        }
+
+        std::vector<uint32_t> stop_bus_offsets{0};
+        std::vector<domain::BusId> stop_buses;
+        std::vector<uint32_t> distance_offsets{0};
+        std::vector<domain::RoadDistance> distances;
+        for (domain::StopId id = 0; id < stop_count; ++id) {
+            const auto buses_of_stop = catalogue.GetStopInfo(id);
+            stop_buses.insert(stop_buses.end(), buses_of_stop.begin(), buses_of_stop.end());
+            stop_bus_offsets.push_back(CheckOffset(stop_buses.size()));
+            const auto distances_of_stop = catalogue.GetDistances(id);
+            distances.insert(distances.end(), distances_of_stop.begin(), distances_of_stop.end());
+            distance_offsets.push_back(CheckOffset(distances.size()));
+        }
+
+        // Ячейки хеш-функции с именами и id; у автобусов ключ — позиция в sorted_buses
+        const auto make_slots = [&names, &name_offsets](const std::vector<std::string_view>& keys,
+                                                        const std::vector<uint32_t>& ids,
+                                                        const containers::PerfectHash::Tables& tables) {
+            std::vector<NameSlot> slots;
+            slots.reserve(tables.keys.size());
+            for (const uint32_t key : tables.keys) {
+                slots.push_back({ids.empty() ? key : ids[key], *name_offsets.Find(keys[key]),
+                                 static_cast<uint32_t>(keys[key].size()),
+                                 static_cast<uint32_t>(containers::HashString(keys[key]))});
+            }
+            return slots;
+        };
+        const auto stop_hash = containers::PerfectHash::Build(stop_names);
+        const auto bus_hash = containers::PerfectHash::Build(bus_names);
+        const auto stop_slots = make_slots(stop_names, {}, stop_hash);
+        const auto bus_slots = make_slots(bus_names, sorted_buses, bus_hash);
+
+        // Разделы выровнены по 8 байт, промежутки и хвост заполнены нулями
+        Header header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = SNAPSHOT_VERSION;
+        header.byte_order_mark = BYTE_ORDER_MARK;
+        std::vector<char> bytes(sizeof(Header));
+        const auto append = [&header, &bytes](Section section, const auto& values) {
+            const size_t size = values.size() * sizeof(values[0]);
+            bytes.resize((bytes.size() + alignof(uint64_t) - 1) / alignof(uint64_t) * alignof(uint64_t));
+            header.sections[section] = {bytes.size(), size};
+            const char* data = reinterpret_cast<const char*>(values.data());
+            bytes.insert(bytes.end(), data, data + size);
+        };
+        append(NAMES, names);
+        append(STOPS, stops);
+        append(BUSES, buses);
+        append(BUS_STOPS, bus_stops);
+        append(BUS_ROAD_DISTANCES, bus_road_distances);
+        append(BUS_GEO_DISTANCES, bus_geo_distances);
+        append(SORTED_BUSES, sorted_buses);
+        append(STOP_BUS_OFFSETS, stop_bus_offsets);
+        append(STOP_BUSES, stop_buses);
+        append(DISTANCE_OFFSETS, distance_offsets);
+        append(DISTANCES, distances);
+        append(STOP_HASH_SEEDS, stop_hash.seeds);
+        append(STOP_HASH_SLOTS, stop_slots);
+        append(BUS_HASH_SEEDS, bus_hash.seeds);
+        append(BUS_HASH_SLOTS, bus_slots);
+        bytes.resize((bytes.size() + alignof(uint64_t) - 1) / alignof(uint64_t) * alignof(uint64_t));
+        header.size = bytes.size();
+        header.checksum = containers::HashString({bytes.data() + sizeof(Header), bytes.size() - sizeof(Header)});
+        std::memcpy(bytes.data(), &header, sizeof(Header));
+
+        buffer_.resize(bytes.size() / sizeof(uint64_t));
+        std::memcpy(buffer_.data(), bytes.data(), bytes.size());
+        Open(reinterpret_cast<const char*>(buffer_.data()), bytes.size());
+    }
+
+    CatalogueSnapshot::CatalogueSnapshot(const std::string& path)
+        : file_(std::make_unique<io::MappedFile>(path)) {
+        const char* data = file_->GetData();
+        const size_t size = file_->GetSize();
+        Header header;
+        if (size < sizeof(Header) || std::memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+            throw std::runtime_error("Not a catalogue snapshot: " + path);
+        }
+        std::memcpy(&header, data, sizeof(Header));
+        if (header.version != SNAPSHOT_VERSION || header.byte_order_mark != BYTE_ORDER_MARK) {
+            throw std::runtime_error("Unsupported catalogue snapshot version: " + path);
+        }
+        // Массивы читаются прямо из файла: mmap и запасной буфер выровнены не хуже чем по 8 байт.
+        // Контрольная сумма проверяется только при чтении файла: собранный в памяти буфер ей соответствует
+        CheckSnapshot(reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) == 0 && header.size == size
+                      && header.checksum == containers::HashString({data + sizeof(Header), size - sizeof(Header)}));
+        Open(data, size);
+    }
+
+    template <typename T>
+    ranges::Span<T> CatalogueSnapshot::GetSection(const char* data, size_t size, const Header& header, Section section) {
+        const auto [offset, length] = header.sections[section];
+        CheckSnapshot(offset % alignof(T) == 0 && offset <= size && length <= size - offset && length % sizeof(T) == 0);
+        return {reinterpret_cast<const T*>(data + offset), static_cast<size_t>(length / sizeof(T))};
+    }
+
+    void CatalogueSnapshot::Open(const char* data, size_t size) {
+        CheckSnapshot(size >= sizeof(Header));
+        Header header;
+        std::memcpy(&header, data, sizeof(Header));
+        CheckSnapshot(std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0
+                      && header.version == SNAPSHOT_VERSION && header.byte_order_mark == BYTE_ORDER_MARK
+                      && header.size == size);
+        data_ = data;
+        size_ = size;
+        checksum_ = header.checksum;
+
+        const auto names = GetSection<char>(data, size, header, NAMES);
+        names_ = {names.data(), names.size()};
+        const auto stops = GetSection<StopRecord>(data, size, header, STOPS);
+        const auto buses = GetSection<BusRecord>(data, size, header, BUSES);
+        bus_stops_ = GetSection<domain::StopId>(data, size, header, BUS_STOPS);
+        bus_road_distances_ = GetSection<int>(data, size, header, BUS_ROAD_DISTANCES);
+        bus_geo_distances_ = GetSection<double>(data, size, header, BUS_GEO_DISTANCES);
+        const auto sorted_buses = GetSection<domain::BusId>(data, size, header, SORTED_BUSES);
+        stop_bus_offsets_ = GetSection<uint32_t>(data, size, header, STOP_BUS_OFFSETS);
+        stop_buses_ = GetSection<domain::BusId>(data, size, header, STOP_BUSES);
+        distance_offsets_ = GetSection<uint32_t>(data, size, header, DISTANCE_OFFSETS);
+        distances_ = GetSection<domain::RoadDistance>(data, size, header, DISTANCES);
+        const auto stop_hash_seeds = GetSection<uint32_t>(data, size, header, STOP_HASH_SEEDS);
+        stop_slots_ = GetSection<NameSlot>(data, size, header, STOP_HASH_SLOTS);
+        const auto bus_hash_seeds = GetSection<uint32_t>(data, size, header, BUS_HASH_SEEDS);
+        bus_slots_ = GetSection<NameSlot>(data, size, header, BUS_HASH_SLOTS);
+
+        // Все номера и смещения проверяются один раз, дальше запросы читают массивы без проверок
+        const size_t stop_count = stops.size();
+        const size_t bus_count = buses.size();
+        const auto get_name = [this](uint32_t offset, uint32_t name_size) {
+            CheckSnapshot(offset <= names_.size() && name_size <= names_.size() - offset);
+            return names_.substr(offset, name_size);
+        };
+        CheckSnapshot(bus_road_distances_.size() == bus_stops_.size() && bus_geo_distances_.size() == bus_stops_.size());
+        for (const domain::StopId stop : bus_stops_) {
+            CheckSnapshot(stop < stop_count);
+        }
+        CheckOffsets(stop_bus_offsets_, stop_count, stop_buses_.size());
+        for (const domain::BusId bus : stop_buses_) {
+            CheckSnapshot(bus < bus_count);
+        }
+        CheckOffsets(distance_offsets_, stop_count, distances_.size());
+        for (const domain::RoadDistance& distance : distances_) {
+            CheckSnapshot(distance.to < stop_count);
+        }
+        CheckSnapshot(stop_hash_seeds.size() == containers::PerfectHash::GetBucketCount(stop_count)
+                      && stop_slots_.size() == stop_count
+                      && bus_hash_seeds.size() == containers::PerfectHash::GetBucketCount(sorted_buses.size())
+                      && bus_slots_.size() == sorted_buses.size());
+        for (const NameSlot& slot : stop_slots_) {
+            CheckSnapshot(slot.id < stop_count);
+            get_name(slot.name_offset, slot.name_size);
+        }
+        for (const NameSlot& slot : bus_slots_) {
+            CheckSnapshot(slot.id < bus_count);
+            get_name(slot.name_offset, slot.name_size);
+        }
+        stop_hash_ = {stop_hash_seeds.data(), stop_hash_seeds.size(), stop_count};
+        bus_hash_ = {bus_hash_seeds.data(), bus_hash_seeds.size(), sorted_buses.size()};
+
+        stops_.clear();
+        stops_.reserve(stop_count);
+        for (const StopRecord& stop : stops) {
+            stops_.push_back({get_name(stop.name_offset, stop.name_size), {stop.lat, stop.lng},
+                              static_cast<domain::StopId>(stops_.size())});
+        }
+        buses_.clear();
+        buses_.reserve(bus_count);
+        for (const BusRecord& bus : buses) {
+            CheckSnapshot(bus.stops_offset <= bus_stops_.size() && bus.stop_count <= bus_stops_.size() - bus.stops_offset);
+            domain::Bus& result = buses_.emplace_back();
+            result.name = get_name(bus.name_offset, bus.name_size);
+            result.stops = {bus_stops_.data() + bus.stops_offset, bus.stop_count};
+            result.is_roundtrip = bus.is_roundtrip != 0;
+            result.id = static_cast<domain::BusId>(buses_.size() - 1);
+            result.road_distances = {bus_road_distances_.data() + bus.stops_offset, bus.stop_count};
+            result.geo_distances = {bus_geo_distances_.data() + bus.stops_offset, bus.stop_count};
+            result.stat = {bus.curve, bus.route_length, static_cast<int>(bus.stop_count), bus.unique_stop_count};
+        }
+        sorted_buses_.clear();
+        sorted_buses_.reserve(sorted_buses.size());
+        for (const domain::BusId bus : sorted_buses) {
+            CheckSnapshot(bus < bus_count);
+            sorted_buses_.emplace_back(buses_[bus].name, &buses_[bus]);
+        }
+    }
+
+    const CatalogueSnapshot::NameSlot* CatalogueSnapshot::FindName(const containers::PerfectHash& hash,
+                                                                   ranges::Span<NameSlot> slots,
+                                                                   std::string_view name) const {
+        const uint64_t name_hash = containers::HashString(name);
+        const uint32_t slot = hash.Find(name_hash);
+        if (slot == containers::PerfectHash::NO_KEY || slots[slot].fingerprint != static_cast<uint32_t>(name_hash)
+            || std::string_view(names_.data() + slots[slot].name_offset, slots[slot].name_size) != name) {
+            return nullptr;
+        }
+        return &slots[slot];
+    }
+
+    const domain::Stop* CatalogueSnapshot::FindStop(std::string_view name) const {
+        const NameSlot* slot = FindName(stop_hash_, stop_slots_, name);
+        return slot == nullptr ? nullptr : &stops_[slot->id];
+    }
+
+    const domain::Stop& CatalogueSnapshot::GetStop(domain::StopId id) const {
+        return stops_.at(id);
+    }
+
+    const domain::Bus* CatalogueSnapshot::FindBus(std::string_view name) const {
+        const NameSlot* slot = FindName(bus_hash_, bus_slots_, name);
+        return slot == nullptr ? nullptr : &buses_[slot->id];
+    }
+
+    const domain::Bus& CatalogueSnapshot::GetBus(domain::BusId id) const {
+        return buses_.at(id);
+    }
+
+    ranges::Span<domain::BusId> CatalogueSnapshot::GetStopBuses(domain::StopId id) const {
+        if (id >= stops_.size()) {
+            throw std::out_of_range("Stop is out of range");
+        }
+        return {stop_buses_.data() + stop_bus_offsets_[id], stop_bus_offsets_[id + 1] - stop_bus_offsets_[id]};
+    }
+
+    ranges::Span<domain::RoadDistance> CatalogueSnapshot::GetDistances(domain::StopId id) const {
+        if (id >= stops_.size()) {
+            throw std::out_of_range("Stop is out of range");
+        }
+        return {distances_.data() + distance_offsets_[id], distance_offsets_[id + 1] - distance_offsets_[id]};
+    }
+
+    const std::vector<std::pair<std::string_view, const domain::Bus*>>& CatalogueSnapshot::GetAllBuses() const {
+        return sorted_buses_;
+    }
+
+    size_t CatalogueSnapshot::GetStopCount() const {
+        return stops_.size();
+    }
+
+    size_t CatalogueSnapshot::GetBusCount() const {
+        return buses_.size();
+    }
+
+    size_t CatalogueSnapshot::GetMemoryUsage() const {
+        return size_ + stops_.capacity() * sizeof(domain::Stop)
+             + buses_.capacity() * sizeof(domain::Bus)
+             + sorted_buses_.capacity() * sizeof(std::pair<std::string_view, const domain::Bus*>);
+    }
+
+    uint64_t CatalogueSnapshot::GetChecksum() const {
+        return checksum_;
+    }
+
+    void CatalogueSnapshot::Save(std::ostream& output) const {
+        output.write(data_, static_cast<std::streamsize>(size_));
+    }
+
+}  // namespace catalogue
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "domain.h"
+#include "mapped_file.h"
+#include "perfect_hash.h"
+#include "ranges.h"
+
+namespace catalogue {
+
+class TransportCatalogue;
+
+// Неизменяемый снимок каталога для чтения. Все данные — плоские массивы без указателей
+// в одном выровненном буфере: имена подряд в одном блоке, остановки всех автобусов —
+// в одном массиве id, накопленные расстояния — в параллельных ему массивах, автобусы
+// остановок и дорожные расстояния — в общих массивах со смещениями по id остановки.
+// Имена ищутся минимальными совершенными хеш-функциями (perfect_hash.h).
+// Stop и Bus, которые возвращает снимок, только ссылаются на эти массивы.
+// Буфер не зависит от адреса, по которому лежит, поэтому записывается в файл как есть (Save)
+// и читается из отображённого в память файла без разбора и копирования массивов
+class CatalogueSnapshot {
+public:
+    // Собирает снимок из незамороженного каталога
+    explicit CatalogueSnapshot(const TransportCatalogue& catalogue);
+    // Снимок из файла, записанного Save. Бросает std::runtime_error, если файл не открывается,
+    // записан другой версией или на машине с другим порядком байтов либо повреждён
+    explicit CatalogueSnapshot(const std::string& path);
+
+    CatalogueSnapshot(const CatalogueSnapshot&) = delete;
+    CatalogueSnapshot& operator=(const CatalogueSnapshot&) = delete;
+
+    const domain::Stop* FindStop(std::string_view name) const;
+    const domain::Stop& GetStop(domain::StopId id) const;
+
+    // Только действующие автобусы
+    const domain::Bus* FindBus(std::string_view name) const;
+    // Доступен и заменённый или удалённый автобус
+    const domain::Bus& GetBus(domain::BusId id) const;
+
+    // id автобусов, проходящих через остановку, по возрастанию имени
+    ranges::Span<domain::BusId> GetStopBuses(domain::StopId id) const;
+    // Заданные дорожные расстояния из остановки по возрастанию id остановки назначения
+    ranges::Span<domain::RoadDistance> GetDistances(domain::StopId id) const;
+
+    // Действующие автобусы по возрастанию имени
+    const std::vector<std::pair<std::string_view, const domain::Bus*>>& GetAllBuses() const;
+
+    size_t GetStopCount() const;
+    size_t GetBusCount() const;
+
+    size_t GetMemoryUsage() const;
+
+    // Контрольная сумма содержимого, записанная в заголовке
+    uint64_t GetChecksum() const;
+
+    // Записывает буфер снимка целиком
+    void Save(std::ostream& output) const;
+
+private:
+    // Разделы буфера в порядке размещения
+    enum Section : uint32_t {
+        NAMES,
+        STOPS,
+        BUSES,
+        BUS_STOPS,
+        BUS_ROAD_DISTANCES,
+        BUS_GEO_DISTANCES,
+        SORTED_BUSES,
+        STOP_BUS_OFFSETS,
+        STOP_BUSES,
+        DISTANCE_OFFSETS,
+        DISTANCES,
+        STOP_HASH_SEEDS,
+        STOP_HASH_SLOTS,
+        BUS_HASH_SEEDS,
+        BUS_HASH_SLOTS,
+        SECTION_COUNT,
+    };
+
+    // Смещение и длина раздела в байтах от начала буфера
+    struct SectionRecord {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order_mark;
+        uint64_t size;
+        // HashString от всех байтов после заголовка
+        uint64_t checksum;
+        SectionRecord sections[SECTION_COUNT];
+    };
+
+    struct StopRecord {
+        uint32_t name_offset;
+        uint32_t name_size;
+        double lat;
+        double lng;
+    };
+
+    // Поля без неявного выравнивания, чтобы в буфере не оставалось неинициализированных байтов
+    struct BusRecord {
+        uint32_t name_offset;
+        uint32_t name_size;
+        // Позиция первой остановки в BUS_STOPS и в массивах расстояний
+        uint32_t stops_offset;
+        uint32_t stop_count;
+        double curve;
+        int route_length;
+        int unique_stop_count;
+        uint32_t is_roundtrip;
+        uint32_t padding;
+    };
+
+    // Ячейка совершенной хеш-функции: имя ключа для проверки и id остановки или автобуса.
+    // По младшим битам хеша отсеиваются чужие ключи, не читая имён
+    struct NameSlot {
+        uint32_t id;
+        uint32_t name_offset;
+        uint32_t name_size;
+        uint32_t fingerprint;
+    };
+
+    // Проверяет заголовок и разделы буфера и строит по ним Stop, Bus и хеш-функции
+    void Open(const char* data, size_t size);
+
+    // Ячейка с именем name или nullptr
+    const NameSlot* FindName(const containers::PerfectHash& hash, ranges::Span<NameSlot> slots, std::string_view name) const;
+
+    template <typename T>
+    static ranges::Span<T> GetSection(const char* data, size_t size, const Header& header, Section section);
+
+    // Собранный в памяти буфер или отображённый файл
+    std::vector<uint64_t> buffer_;
+    std::unique_ptr<io::MappedFile> file_;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    uint64_t checksum_ = 0;
+
+    std::string_view names_;
+    ranges::Span<domain::StopId> bus_stops_;
+    ranges::Span<int> bus_road_distances_;
+    ranges::Span<double> bus_geo_distances_;
+    ranges::Span<uint32_t> stop_bus_offsets_;
+    ranges::Span<domain::BusId> stop_buses_;
+    ranges::Span<uint32_t> distance_offsets_;
+    ranges::Span<domain::RoadDistance> distances_;
+    containers::PerfectHash stop_hash_;
+    ranges::Span<NameSlot> stop_slots_;
+    containers::PerfectHash bus_hash_;
+    ranges::Span<NameSlot> bus_slots_;
+
+    std::vector<domain::Stop> stops_;
+    std::vector<domain::Bus> buses_;
+    std::vector<std::pair<std::string_view, const domain::Bus*>> sorted_buses_;
+};
+
+}  // namespace catalogue
@@ -0,0 +1,542 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "shortest_path_tree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Иерархии сжатия (contraction hierarchies). Вершины по очереди «сжимаются»: пути через
+// сжимаемую вершину заменяются ярлыками (shortcut), если нет пути-свидетеля не длиннее.
+// Запрос — двунаправленная Дейкстра только по рёбрам, ведущим вверх по порядку сжатия;
+// найденные ярлыки раскрываются обратно в исходные рёбра графа.
+template <typename Weight>
+class ContractionHierarchy final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+    using Duration = std::chrono::duration<double, std::milli>;
+    using Clock = std::chrono::steady_clock;
+
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+
+    explicit ContractionHierarchy(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const override;
+
+    // Поиск «многие ко многим» с корзинами: обратный поиск вверх по иерархии из каждой цели
+    // раскладывает по вершинам пары (цель, вес), прямой поиск из источника собирает их
+    std::vector<std::optional<Weight>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                         const std::vector<VertexId>& targets) const override;
+
+    size_t GetMemoryUsage() const override;
+
+    void PrintStats(std::ostream& output) const override;
+
+private:
+    // Начиная с этого числа целей из одного источника полный проход Дейкстры по исходному графу
+    // дешевле отдельных запросов по иерархии
+    static constexpr size_t MIN_TREE_TARGETS = 16;
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHED_WEIGHT = std::numeric_limits<Weight>::max();
+    static constexpr size_t NO_INDEX = std::numeric_limits<size_t>::max();
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    // Ограничение поиска свидетеля: если он не найден за это число вершин, ярлык добавляется
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 50;
+
+    // Ребро иерархии: либо исходное ребро графа, либо ярлык из двух рёбер иерархии
+    struct ChEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId original_edge;
+        size_t first_part;
+        size_t second_part;
+    };
+
+    struct Arc {
+        VertexId target;
+        Weight weight;
+        size_t ch_edge;
+    };
+
+    // Списки дуг в виде CSR: дуги вершины v лежат в [offsets[v], offsets[v + 1])
+    struct SearchGraph {
+        std::vector<size_t> offsets;
+        std::vector<Arc> arcs;
+    };
+
+    // Переиспользуемое состояние поиска: сбрасываются только затронутые вершины
+    struct SearchSpace {
+        std::vector<Weight> weights;
+        std::vector<size_t> parent_edges;
+        std::vector<VertexId> touched;
+
+        explicit SearchSpace(size_t vertex_count = 0)
+            : weights(vertex_count, UNREACHED_WEIGHT)
+            , parent_edges(vertex_count, NO_INDEX) {
+        }
+
+        void Set(VertexId vertex, Weight weight, size_t parent_edge) {
+            if (weights[vertex] == UNREACHED_WEIGHT) {
+                touched.push_back(vertex);
+            }
+            weights[vertex] = weight;
+            parent_edges[vertex] = parent_edge;
+        }
+
+        void Reset() {
+            for (const VertexId vertex : touched) {
+                weights[vertex] = UNREACHED_WEIGHT;
+                parent_edges[vertex] = NO_INDEX;
+            }
+            touched.clear();
+        }
+    };
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    void InitializeWorkingGraph() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        out_arcs_.assign(vertex_count, {});
+        in_arcs_.assign(vertex_count, {});
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                if (edge.weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                if (edge.from == edge.to) {
+                    continue;
+                }
+                ch_edges_.push_back({edge.from, edge.to, edge.weight, edge_id, NO_INDEX, NO_INDEX});
+                AddOrImproveArc(edge.from, edge.to, edge.weight, ch_edges_.size() - 1);
+            }
+        }
+    }
+
+    // Между парой вершин хранится только самая лёгкая дуга
+    void AddOrImproveArc(VertexId from, VertexId to, Weight weight, size_t ch_edge) {
+        auto& out_arcs = out_arcs_[from];
+        auto it = std::find_if(out_arcs.begin(), out_arcs.end(), [to](const Arc& arc) {
+            return arc.target == to;
+        });
+        if (it == out_arcs.end()) {
+            out_arcs.push_back({to, weight, ch_edge});
+            in_arcs_[to].push_back({from, weight, ch_edge});
+            return;
+        }
+        if (weight < it->weight) {
+            *it = {to, weight, ch_edge};
+            auto& in_arcs = in_arcs_[to];
+            auto in_it = std::find_if(in_arcs.begin(), in_arcs.end(), [from](const Arc& arc) {
+                return arc.target == from;
+            });
+            *in_it = {from, weight, ch_edge};
+        }
+    }
+
+    // Ищет пути из source в обход excluded и сжатых вершин не длиннее max_weight
+    void RunWitnessSearch(VertexId source, VertexId excluded, Weight max_weight) {
+        witness_space_.Reset();
+        Queue queue;
+        witness_space_.Set(source, ZERO_WEIGHT, NO_INDEX);
+        queue.push({ZERO_WEIGHT, source});
+        size_t settled = 0;
+        while (!queue.empty() && settled < WITNESS_SETTLE_LIMIT) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > witness_space_.weights[vertex]) {
+                continue;
+            }
+            if (weight > max_weight) {
+                break;
+            }
+            ++settled;
+            for (const Arc& arc : out_arcs_[vertex]) {
+                if (arc.target == excluded || contracted_[arc.target]) {
+                    continue;
+                }
+                const Weight candidate_weight = weight + arc.weight;
+                if (candidate_weight < witness_space_.weights[arc.target]) {
+                    witness_space_.Set(arc.target, candidate_weight, NO_INDEX);
+                    queue.push({candidate_weight, arc.target});
+                }
+            }
+        }
+    }
+
+    struct Shortcut {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        size_t first_part;
+        size_t second_part;
+    };
+
+    // Ярлыки, которые нужны, чтобы сжать вершину без потери кратчайших путей
+    std::vector<Shortcut> FindShortcuts(VertexId vertex) {
+        std::vector<Shortcut> shortcuts;
+        for (const Arc& in_arc : in_arcs_[vertex]) {
+            if (contracted_[in_arc.target]) {
+                continue;
+            }
+            Weight max_weight = ZERO_WEIGHT;
+            for (const Arc& out_arc : out_arcs_[vertex]) {
+                if (!contracted_[out_arc.target] && out_arc.target != in_arc.target) {
+                    max_weight = std::max(max_weight, in_arc.weight + out_arc.weight);
+                }
+            }
+            RunWitnessSearch(in_arc.target, vertex, max_weight);
+            for (const Arc& out_arc : out_arcs_[vertex]) {
+                if (contracted_[out_arc.target] || out_arc.target == in_arc.target) {
+                    continue;
+                }
+                const Weight via_weight = in_arc.weight + out_arc.weight;
+                if (witness_space_.weights[out_arc.target] > via_weight) {
+                    shortcuts.push_back({in_arc.target, out_arc.target, via_weight, in_arc.ch_edge, out_arc.ch_edge});
+                }
+            }
+        }
+        return shortcuts;
+    }
+
+    void AddShortcuts(const std::vector<Shortcut>& shortcuts) {
+        for (const Shortcut& shortcut : shortcuts) {
+            ch_edges_.push_back({shortcut.from, shortcut.to, shortcut.weight, NO_EDGE,
+                                 shortcut.first_part, shortcut.second_part});
+            AddOrImproveArc(shortcut.from, shortcut.to, shortcut.weight, ch_edges_.size() - 1);
+        }
+        shortcut_count_ += shortcuts.size();
+    }
+
+    // Разность рёбер с учётом уже сжатых соседей
+    long long ComputePriority(VertexId vertex, size_t shortcut_count) const {
+        long long removed_arcs = 0;
+        for (const Arc& arc : in_arcs_[vertex]) {
+            removed_arcs += contracted_[arc.target] ? 0 : 1;
+        }
+        for (const Arc& arc : out_arcs_[vertex]) {
+            removed_arcs += contracted_[arc.target] ? 0 : 1;
+        }
+        return static_cast<long long>(shortcut_count) - removed_arcs
+             + static_cast<long long>(contracted_neighbors_[vertex]);
+    }
+
+    void ContractAll() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        contracted_.assign(vertex_count, false);
+        contracted_neighbors_.assign(vertex_count, 0);
+        witness_space_ = SearchSpace(vertex_count);
+
+        using OrderItem = std::pair<long long, VertexId>;
+        std::priority_queue<OrderItem, std::vector<OrderItem>, std::greater<OrderItem>> order;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            order.push({ComputePriority(vertex, FindShortcuts(vertex).size()), vertex});
+        }
+
+        std::vector<std::vector<Arc>> upward_arcs(vertex_count);
+        std::vector<std::vector<Arc>> downward_arcs(vertex_count);
+        size_t rank = 0;
+        while (!order.empty()) {
+            const VertexId vertex = order.top().second;
+            order.pop();
+            // Ленивое обновление: приоритет пересчитывается при извлечении
+            const auto shortcuts = FindShortcuts(vertex);
+            const long long priority = ComputePriority(vertex, shortcuts.size());
+            if (!order.empty() && priority > order.top().first) {
+                order.push({priority, vertex});
+                continue;
+            }
+
+            AddShortcuts(shortcuts);
+            contracted_[vertex] = true;
+            ranks_[vertex] = rank++;
+            for (const Arc& arc : out_arcs_[vertex]) {
+                if (!contracted_[arc.target]) {
+                    upward_arcs[vertex].push_back(arc);
+                    ++contracted_neighbors_[arc.target];
+                }
+            }
+            for (const Arc& arc : in_arcs_[vertex]) {
+                if (!contracted_[arc.target]) {
+                    downward_arcs[vertex].push_back(arc);
+                    ++contracted_neighbors_[arc.target];
+                }
+            }
+            out_arcs_[vertex].clear();
+            out_arcs_[vertex].shrink_to_fit();
+            in_arcs_[vertex].clear();
+            in_arcs_[vertex].shrink_to_fit();
+        }
+
+        forward_graph_ = ToSearchGraph(upward_arcs);
+        backward_graph_ = ToSearchGraph(downward_arcs);
+        out_arcs_.clear();
+        in_arcs_.clear();
+        contracted_.clear();
+        contracted_neighbors_.clear();
+        witness_space_ = SearchSpace();
+    }
+
+    static SearchGraph ToSearchGraph(const std::vector<std::vector<Arc>>& arcs_by_vertex) {
+        SearchGraph search_graph;
+        search_graph.offsets.reserve(arcs_by_vertex.size() + 1);
+        search_graph.offsets.push_back(0);
+        for (const auto& arcs : arcs_by_vertex) {
+            search_graph.arcs.insert(search_graph.arcs.end(), arcs.begin(), arcs.end());
+            search_graph.offsets.push_back(search_graph.arcs.size());
+        }
+        return search_graph;
+    }
+
+    // Шаг одного направления двунаправленного поиска
+    static void SearchStep(const SearchGraph& search_graph, Queue& queue, SearchSpace& space,
+                           const SearchSpace& opposite_space, Weight& best_weight, VertexId& meeting_vertex) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weight > space.weights[vertex]) {
+            return;
+        }
+        if (opposite_space.weights[vertex] != UNREACHED_WEIGHT
+            && weight + opposite_space.weights[vertex] < best_weight) {
+            best_weight = weight + opposite_space.weights[vertex];
+            meeting_vertex = vertex;
+        }
+        for (size_t i = search_graph.offsets[vertex]; i < search_graph.offsets[vertex + 1]; ++i) {
+            const Arc& arc = search_graph.arcs[i];
+            const Weight candidate_weight = weight + arc.weight;
+            if (candidate_weight < space.weights[arc.target]) {
+                space.Set(arc.target, candidate_weight, arc.ch_edge);
+                queue.push({candidate_weight, arc.target});
+            }
+        }
+    }
+
+    // Полный поиск из start по дугам, ведущим вверх по иерархии; веса достигнутых вершин
+    // остаются в space, сами вершины — в space.touched
+    static void UpwardSearch(const SearchGraph& search_graph, VertexId start, SearchSpace& space) {
+        space.Reset();
+        Queue queue;
+        space.Set(start, ZERO_WEIGHT, NO_INDEX);
+        queue.push({ZERO_WEIGHT, start});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > space.weights[vertex]) {
+                continue;
+            }
+            for (size_t i = search_graph.offsets[vertex]; i < search_graph.offsets[vertex + 1]; ++i) {
+                const Arc& arc = search_graph.arcs[i];
+                const Weight candidate_weight = weight + arc.weight;
+                if (candidate_weight < space.weights[arc.target]) {
+                    space.Set(arc.target, candidate_weight, arc.ch_edge);
+                    queue.push({candidate_weight, arc.target});
+                }
+            }
+        }
+    }
+
+    // Раскрывает ребро иерархии в последовательность исходных рёбер
+    void UnpackEdge(size_t ch_edge, std::vector<EdgeId>& edges) const {
+        std::vector<size_t> stack{ch_edge};
+        while (!stack.empty()) {
+            const ChEdge& edge = ch_edges_[stack.back()];
+            stack.pop_back();
+            if (edge.original_edge != NO_EDGE) {
+                edges.push_back(edge.original_edge);
+            } else {
+                stack.push_back(edge.second_part);
+                stack.push_back(edge.first_part);
+            }
+        }
+    }
+
+    const Graph& graph_;
+    std::vector<ChEdge> ch_edges_;
+    std::vector<size_t> ranks_;
+    SearchGraph forward_graph_;
+    SearchGraph backward_graph_;
+    size_t shortcut_count_ = 0;
+    Duration preprocessing_time_{};
+
+    // Рабочее состояние предобработки
+    std::vector<std::vector<Arc>> out_arcs_;
+    std::vector<std::vector<Arc>> in_arcs_;
+    std::vector<bool> contracted_;
+    std::vector<size_t> contracted_neighbors_;
+    SearchSpace witness_space_;
+
+    // Состояние запросов
+    mutable SearchSpace forward_space_;
+    mutable SearchSpace backward_space_;
+    // Полные деревья, построенные для пакетов запросов из одного источника
+    mutable size_t tree_count_ = 0;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : graph_(graph)
+    , ranks_(graph.GetVertexCount())
+    , forward_space_(graph.GetVertexCount())
+    , backward_space_(graph.GetVertexCount())
+{
+    const auto start = Clock::now();
+    InitializeWorkingGraph();
+    ContractAll();
+    preprocessing_time_ = Clock::now() - start;
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+    forward_space_.Reset();
+    backward_space_.Reset();
+
+    Queue forward_queue;
+    Queue backward_queue;
+    forward_space_.Set(from, ZERO_WEIGHT, NO_INDEX);
+    backward_space_.Set(to, ZERO_WEIGHT, NO_INDEX);
+    forward_queue.push({ZERO_WEIGHT, from});
+    backward_queue.push({ZERO_WEIGHT, to});
+
+    Weight best_weight = UNREACHED_WEIGHT;
+    VertexId meeting_vertex = from;
+    while (!forward_queue.empty() || !backward_queue.empty()) {
+        const Weight forward_min = forward_queue.empty() ? UNREACHED_WEIGHT : forward_queue.top().first;
+        const Weight backward_min = backward_queue.empty() ? UNREACHED_WEIGHT : backward_queue.top().first;
+        if (std::min(forward_min, backward_min) >= best_weight) {
+            break;
+        }
+        if (forward_min <= backward_min) {
+            SearchStep(forward_graph_, forward_queue, forward_space_, backward_space_, best_weight, meeting_vertex);
+        } else {
+            SearchStep(backward_graph_, backward_queue, backward_space_, forward_space_, best_weight, meeting_vertex);
+        }
+    }
+
+    std::optional<RouteInfo> result;
+    if (best_weight != UNREACHED_WEIGHT) {
+        std::vector<size_t> forward_part;
+        for (VertexId vertex = meeting_vertex; forward_space_.parent_edges[vertex] != NO_INDEX;
+             vertex = ch_edges_[forward_space_.parent_edges[vertex]].from) {
+            forward_part.push_back(forward_space_.parent_edges[vertex]);
+        }
+        std::vector<EdgeId> edges;
+        for (auto it = forward_part.rbegin(); it != forward_part.rend(); ++it) {
+            UnpackEdge(*it, edges);
+        }
+        for (VertexId vertex = meeting_vertex; backward_space_.parent_edges[vertex] != NO_INDEX;
+             vertex = ch_edges_[backward_space_.parent_edges[vertex]].to) {
+            UnpackEdge(backward_space_.parent_edges[vertex], edges);
+        }
+
+        Weight weight = ZERO_WEIGHT;
+        for (const EdgeId edge_id : edges) {
+            weight += graph_.GetEdge(edge_id).weight;
+        }
+        result = RouteInfo{weight, std::move(edges)};
+    }
+    return result;
+}
+
+template <typename Weight>
+std::vector<std::optional<typename ContractionHierarchy<Weight>::RouteInfo>> ContractionHierarchy<Weight>::BuildRoutes(
+    VertexId from, const std::vector<VertexId>& targets) const {
+    if (targets.size() < MIN_TREE_TARGETS) {
+        return RoutingEngine<Weight>::BuildRoutes(from, targets);
+    }
+    const ShortestPathTree<Weight> tree = BuildShortestPathTree(graph_, from);
+    ++tree_count_;
+    std::vector<std::optional<RouteInfo>> routes;
+    routes.reserve(targets.size());
+    for (const VertexId to : targets) {
+        routes.push_back(ExtractRoute(graph_, tree, to));
+    }
+    return routes;
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> ContractionHierarchy<Weight>::BuildWeightMatrix(
+    const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    for (const auto* vertices : {&sources, &targets}) {
+        for (const VertexId vertex : *vertices) {
+            if (vertex >= vertex_count) {
+                throw std::out_of_range("Vertex is out of range");
+            }
+        }
+    }
+
+    // Корзина вершины v: номера целей и веса путей v → цель в обратных поисках
+    std::unordered_map<VertexId, std::vector<std::pair<size_t, Weight>>> buckets;
+    for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+        UpwardSearch(backward_graph_, targets[target_index], backward_space_);
+        for (const VertexId vertex : backward_space_.touched) {
+            buckets[vertex].emplace_back(target_index, backward_space_.weights[vertex]);
+        }
+    }
+
+    std::vector<Weight> best_weights(sources.size() * targets.size(), UNREACHED_WEIGHT);
+    for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+        UpwardSearch(forward_graph_, sources[source_index], forward_space_);
+        Weight* row = best_weights.data() + source_index * targets.size();
+        for (const VertexId vertex : forward_space_.touched) {
+            const auto it = buckets.find(vertex);
+            if (it == buckets.end()) {
+                continue;
+            }
+            const Weight forward_weight = forward_space_.weights[vertex];
+            for (const auto& [target_index, backward_weight] : it->second) {
+                row[target_index] = std::min(row[target_index], forward_weight + backward_weight);
+            }
+        }
+    }
+    forward_space_.Reset();
+    backward_space_.Reset();
+
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(best_weights.size());
+    for (const Weight weight : best_weights) {
+        weights.push_back(weight == UNREACHED_WEIGHT ? std::nullopt : std::optional<Weight>{weight});
+    }
+    return weights;
+}
+
+template <typename Weight>
+size_t ContractionHierarchy<Weight>::GetMemoryUsage() const {
+    return ch_edges_.capacity() * sizeof(ChEdge)
+         + ranks_.capacity() * sizeof(size_t)
+         + (forward_graph_.offsets.capacity() + backward_graph_.offsets.capacity()) * sizeof(size_t)
+         + (forward_graph_.arcs.capacity() + backward_graph_.arcs.capacity()) * sizeof(Arc)
+         + 2 * graph_.GetVertexCount() * (sizeof(Weight) + sizeof(size_t));
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::PrintStats(std::ostream& output) const {
+    output << "contraction_hierarchy: preprocessing_ms=" << preprocessing_time_.count()
+           << " shortcuts=" << shortcut_count_
+           << " upward_arcs=" << forward_graph_.arcs.size() + backward_graph_.arcs.size()
+           << " trees=" << tree_count_
+           << std::endl;
+}
+
+}  // namespace graph
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "graph.h"
+#include "radix_heap.h"
+#include "router.h"
+#include "shortest_path_tree.h"
+
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace graph {
+
+enum class HeapType {
+    BINARY,
+    RADIX,
+};
+
+// Поиск по требованию: на каждый новый источник запускается Дейкстра,
+// дерево кратчайших путей запоминается и переиспользуется для следующих запросов
+template <typename Weight>
+class DijkstraRouter final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+
+    explicit DijkstraRouter(const Graph& graph, HeapType heap_type = HeapType::BINARY);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Одно дерево на источник, веса читаются из него без восстановления путей
+    std::vector<std::optional<Weight>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                         const std::vector<VertexId>& targets) const override;
+
+    size_t GetMemoryUsage() const override;
+
+    // Сохраняет только деревья, не использующие удалённых рёбер и не улучшаемые добавленными
+    bool ApplyUpdate(const GraphUpdate<Weight>& update) override;
+
+    size_t GetCachedTreeCount() const;
+
+private:
+    static constexpr Weight UNREACHED_WEIGHT = ShortestPathTree<Weight>::UNREACHED_WEIGHT;
+
+    using Tree = ShortestPathTree<Weight>;
+
+    const Tree& GetTree(VertexId from) const {
+        if (from >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        auto it = trees_.find(from);
+        if (it == trees_.end()) {
+            it = trees_.emplace(from, heap_type_ == HeapType::RADIX
+                                          ? BuildShortestPathTree<Weight, RadixHeap<Weight, VertexId>>(graph_, from)
+                                          : BuildShortestPathTree<Weight>(graph_, from)).first;
+        }
+        return it->second;
+    }
+
+    const Graph& graph_;
+    HeapType heap_type_;
+    mutable std::unordered_map<VertexId, Tree> trees_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph, HeapType heap_type)
+    : graph_(graph)
+    , heap_type_(heap_type)
+{
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    return ExtractRoute(graph_, GetTree(from), to);
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> DijkstraRouter<Weight>::BuildWeightMatrix(
+    const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(sources.size() * targets.size());
+    for (const VertexId from : sources) {
+        AppendTreeWeights(GetTree(from), targets, weights);
+    }
+    return weights;
+}
+
+template <typename Weight>
+size_t DijkstraRouter<Weight>::GetMemoryUsage() const {
+    size_t memory_usage = 0;
+    for (const auto& [_, tree] : trees_) {
+        memory_usage += tree.weights.capacity() * sizeof(Weight)
+                      + tree.prev_edges.capacity() * sizeof(EdgeId);
+    }
+    return memory_usage;
+}
+
+template <typename Weight>
+bool DijkstraRouter<Weight>::ApplyUpdate(const GraphUpdate<Weight>& update) {
+    const size_t vertex_count = graph_.GetVertexCount();
+    for (auto it = trees_.begin(); it != trees_.end();) {
+        Tree& tree = it->second;
+        bool valid = true;
+        for (EdgeId& edge_id : tree.prev_edges) {
+            if (edge_id != NO_EDGE_ID) {
+                edge_id = update.new_edge_ids[edge_id];
+                valid = valid && edge_id != NO_EDGE_ID;
+            }
+        }
+        tree.weights.resize(vertex_count, UNREACHED_WEIGHT);
+        tree.prev_edges.resize(vertex_count, NO_EDGE_ID);
+        for (const EdgeId edge_id : update.added_edges) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            valid = valid && (tree.weights[edge.from] == UNREACHED_WEIGHT
+                              || !(tree.weights[edge.from] + edge.weight < tree.weights[edge.to]));
+        }
+        it = valid ? std::next(it) : trees_.erase(it);
+    }
+    return true;
+}
+
+template <typename Weight>
+size_t DijkstraRouter<Weight>::GetCachedTreeCount() const {
+    return trees_.size();
+}
+
+}  // namespace graph
@@ -1,23 +1,24 @@
 #pragma once
 
-#include <string>
-#include <vector>
+#include <cstdint>
+#include <string_view>
 
 #include "geo.h"
+#include "ranges.h"
 
 namespace domain {
 
+// Плотные номера в порядке добавления в каталог; не меняются при замене и удалении автобусов
+using StopId = uint32_t;
+using BusId = uint32_t;
+
+// Имена указывают в арену строк каталога
 struct Stop {
-    std::string name;
+    std::string_view name;
     geo::Coordinates coord;
+    StopId id = 0;
 };
 
-struct Bus {
-    std::string name;
-    std::vector<Stop*> stops;
-    bool is_roundtrip;
-};    
-    
 struct BusStat {
     double curve = 0.0;
     int route_length = 0;
@@ -25,4 +26,24 @@ struct BusStat {
     int unique_stop_count = 0;
 };
 
+// Остановки и расстояния лежат в хранилище каталога, до Freeze — в отдельных векторах
+// каждого автобуса, после — в общих массивах снимка
+struct Bus {
+    std::string_view name;
+    ranges::Span<StopId> stops;
+    bool is_roundtrip = false;
+    BusId id = 0;
+    // Заполняются каталогом: расстояния от первой остановки до каждой по дорогам
+    // и по прямой, так что длина любого участка — разность двух элементов
+    ranges::Span<int> road_distances;
+    ranges::Span<double> geo_distances;
+    BusStat stat;
+};
+
+// Заданное дорожное расстояние до остановки to
+struct RoadDistance {
+    StopId to = 0;
+    int distance = 0;
+};
+
 }
\ No newline at end of file
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace containers {
+
+// Финализатор MurmurHash3: каждый бит результата зависит от всех битов входа,
+// поэтому младшие биты годятся для индекса в таблице размера степени двойки
+inline uint64_t MixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+template <typename Key>
+struct MixedHash {
+    size_t operator()(const Key& key) const {
+        return MixHash(std::hash<Key>{}(key));
+    }
+};
+
+// Хеш строк для поиска по std::string_view, std::string и const char* без создания ключа
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view str) const {
+        return MixHash(std::hash<std::string_view>{}(str));
+    }
+};
+
+// Хеш-таблица с открытой адресацией и линейным пробированием по схеме Robin Hood:
+// при вставке элемент, ушедший от своей начальной ячейки дальше, занимает место более близкого,
+// поэтому длины проб выравниваются, а поиск отсутствующего ключа останавливается рано.
+// Записи лежат в одном массиве без узлов, рядом — массив 32-битных хешей (0 — пустая ячейка),
+// по которому считается расстояние пробы и отсеиваются несовпадающие ключи без их сравнения.
+// Key и Value должны конструироваться по умолчанию. Вставка и удаление инвалидируют итераторы и указатели.
+template <typename Key, typename Value, typename Hash = MixedHash<Key>, typename KeyEqual = std::equal_to<>>
+class FlatHashMap {
+public:
+    using Entry = std::pair<Key, Value>;
+
+    class ConstIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Entry*;
+        using reference = const Entry&;
+
+        ConstIterator(const FlatHashMap* map, size_t slot)
+            : map_(map)
+            , slot_(slot) {
+            SkipEmpty();
+        }
+        reference operator*() const {
+            return map_->entries_[slot_];
+        }
+        pointer operator->() const {
+            return &map_->entries_[slot_];
+        }
+        ConstIterator& operator++() {
+            ++slot_;
+            SkipEmpty();
+            return *this;
+        }
+        bool operator==(const ConstIterator& other) const {
+            return slot_ == other.slot_;
+        }
+        bool operator!=(const ConstIterator& other) const {
+            return slot_ != other.slot_;
+        }
+
+    private:
+        void SkipEmpty() {
+            while (slot_ < map_->hashes_.size() && map_->hashes_[slot_] == EMPTY) {
+                ++slot_;
+            }
+        }
+
+        const FlatHashMap* map_;
+        size_t slot_;
+    };
+
+    // Указатель на значение по ключу или nullptr. Ключ поиска может быть любого типа,
+    // который принимают Hash и KeyEqual
+    template <typename K>
+    const Value* Find(const K& key) const {
+        const size_t slot = FindSlot(key);
+        return slot == NO_SLOT ? nullptr : &entries_[slot].second;
+    }
+
+    template <typename K>
+    Value* Find(const K& key) {
+        const size_t slot = FindSlot(key);
+        return slot == NO_SLOT ? nullptr : &entries_[slot].second;
+    }
+
+    // Добавляет запись или заменяет значение существующей
+    void Insert(const Key& key, Value value) {
+        if (Value* existing = Find(key)) {
+            *existing = std::move(value);
+            return;
+        }
+        if ((size_ + 1) * MAX_LOAD_DENOMINATOR > hashes_.size() * MAX_LOAD_NUMERATOR) {
+            Rehash(hashes_.empty() ? MIN_CAPACITY : hashes_.size() * 2);
+        }
+        Place(ComputeHash(key), Entry{key, std::move(value)});
+        ++size_;
+    }
+
+    // Возвращает false, если ключа нет. Следующие за удалённой записи сдвигаются назад,
+    // поэтому таблица не копит удалённых ячеек
+    template <typename K>
+    bool Erase(const K& key) {
+        size_t slot = FindSlot(key);
+        if (slot == NO_SLOT) {
+            return false;
+        }
+        const size_t mask = hashes_.size() - 1;
+        for (size_t next = (slot + 1) & mask; hashes_[next] != EMPTY && GetProbeDistance(next) > 0;
+             slot = next, next = (next + 1) & mask) {
+            hashes_[slot] = hashes_[next];
+            entries_[slot] = std::move(entries_[next]);
+        }
+        hashes_[slot] = EMPTY;
+        entries_[slot] = Entry{};
+        --size_;
+        return true;
+    }
+
+    // Готовит таблицу к count записям без перестроений
+    void Reserve(size_t count) {
+        size_t capacity = MIN_CAPACITY;
+        while (count * MAX_LOAD_DENOMINATOR > capacity * MAX_LOAD_NUMERATOR) {
+            capacity *= 2;
+        }
+        if (capacity > hashes_.size()) {
+            Rehash(capacity);
+        }
+    }
+
+    size_t GetSize() const {
+        return size_;
+    }
+
+    size_t GetCapacity() const {
+        return hashes_.size();
+    }
+
+    size_t GetMemoryUsage() const {
+        return hashes_.capacity() * sizeof(uint32_t) + entries_.capacity() * sizeof(Entry);
+    }
+
+    // Порядок обхода не определён
+    ConstIterator begin() const {
+        return {this, 0};
+    }
+
+    ConstIterator end() const {
+        return {this, hashes_.size()};
+    }
+
+private:
+    static constexpr uint32_t EMPTY = 0;
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+    static constexpr size_t MIN_CAPACITY = 16;
+    // Наибольшая заполненность 7/8: с Robin Hood пробы остаются короткими
+    static constexpr size_t MAX_LOAD_NUMERATOR = 7;
+    static constexpr size_t MAX_LOAD_DENOMINATOR = 8;
+
+    template <typename K>
+    uint32_t ComputeHash(const K& key) const {
+        const uint32_t hash = static_cast<uint32_t>(hasher_(key));
+        return hash == EMPTY ? 1 : hash;
+    }
+
+    size_t GetProbeDistance(size_t slot) const {
+        return (slot - hashes_[slot]) & (hashes_.size() - 1);
+    }
+
+    template <typename K>
+    size_t FindSlot(const K& key) const {
+        if (size_ == 0) {
+            return NO_SLOT;
+        }
+        const uint32_t hash = ComputeHash(key);
+        const size_t mask = hashes_.size() - 1;
+        for (size_t slot = hash & mask, distance = 0;; slot = (slot + 1) & mask, ++distance) {
+            // Запись с меньшим расстоянием означает, что искомой дальше быть не может
+            if (hashes_[slot] == EMPTY || GetProbeDistance(slot) < distance) {
+                return NO_SLOT;
+            }
+            if (hashes_[slot] == hash && key_equal_(entries_[slot].first, key)) {
+                return slot;
+            }
+        }
+    }
+
+    // Вставляет запись, которой точно нет в таблице, и есть свободная ячейка
+    void Place(uint32_t hash, Entry entry) {
+        const size_t mask = hashes_.size() - 1;
+        for (size_t slot = hash & mask, distance = 0;; slot = (slot + 1) & mask, ++distance) {
+            if (hashes_[slot] == EMPTY) {
+                hashes_[slot] = hash;
+                entries_[slot] = std::move(entry);
+                return;
+            }
+            const size_t slot_distance = GetProbeDistance(slot);
+            if (slot_distance < distance) {
+                std::swap(hashes_[slot], hash);
+                std::swap(entries_[slot], entry);
+                distance = slot_distance;
+            }
+        }
+    }
+
+    void Rehash(size_t capacity) {
+        std::vector<uint32_t> old_hashes(capacity, EMPTY);
+        std::vector<Entry> old_entries(capacity);
+        hashes_.swap(old_hashes);
+        entries_.swap(old_entries);
+        for (size_t slot = 0; slot < old_hashes.size(); ++slot) {
+            if (old_hashes[slot] != EMPTY) {
+                Place(old_hashes[slot], std::move(old_entries[slot]));
+            }
+        }
+    }
+
+    std::vector<uint32_t> hashes_;
+    std::vector<Entry> entries_;
+    size_t size_ = 0;
+    Hash hasher_;
+    KeyEqual key_equal_;
+};
+
+}  // namespace containers
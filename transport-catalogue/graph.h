@@ -2,8 +2,11 @@
 
 #include "ranges.h"
 
+#include <cassert>
+#include <cstdint>
 #include <cstdlib>
-#include <string_view>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -11,52 +14,136 @@ namespace graph {
 using VertexId = size_t;
 using EdgeId = size_t;
 
+inline constexpr EdgeId NO_EDGE_ID = static_cast<EdgeId>(-1);
+
+// Вершины ребра хранятся в 32 битах, поэтому граф не может быть больше
+using CompactVertexId = uint32_t;
+inline constexpr size_t MAX_VERTEX_COUNT = std::numeric_limits<CompactVertexId>::max();
+
+// Ребро занимает 24 байта при Weight = double (против 48 со string_view и size_t):
+// автобус задаётся индексом в каталоге, а имя восстанавливается только для ответа
 template <typename Weight>
 struct Edge {
-    VertexId from;
-    VertexId to;
+    CompactVertexId from;
+    CompactVertexId to;
     Weight weight;
-    std::string_view bus_name;
-    int span_count;
+    uint32_t bus_id;
+    uint16_t span_count;
 };
 
+// Граф строится вызовами AddEdge и перед поиском маршрутов «замораживается» методом
+// Freeze: рёбра сортируются по начальной вершине и хранятся в одном массиве вместе
+// со смещениями (CSR), так что исходящие рёбра вершины образуют непрерывный диапазон id.
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
-    using IncidenceList = std::vector<EdgeId>;
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using IncidentEdgesRange = decltype(ranges::AsIndexRange(EdgeId{}, EdgeId{}));
 
 public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
+    // Добавляет изолированные вершины с id, следующими за существующими
+    void AddVertices(size_t count);
+    // Ребро исчезнет из графа при следующей заморозке
+    void RemoveEdge(EdgeId edge_id);
+
+    // Переупорядочивает рёбра по начальной вершине и выбрасывает удалённые. Возвращает
+    // новые id рёбер по их старым id (NO_EDGE_ID для удалённых): id, выданные AddEdge,
+    // после заморозки меняются.
+    std::vector<EdgeId> Freeze();
+    bool IsFrozen() const;
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    // Доступно только для замороженного графа
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
 private:
+    size_t vertex_count_ = 0;
     std::vector<Edge<Weight>> edges_;
-    std::vector<IncidenceList> incidence_lists_;
+    // Пометки удаления; пусто, если удалённых рёбер нет
+    std::vector<bool> removed_edges_;
+    // Рёбра вершины v занимают [edge_offsets_[v], edge_offsets_[v + 1])
+    std::vector<EdgeId> edge_offsets_;
 };
 
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+    : vertex_count_(vertex_count) {
+    if (vertex_count_ > MAX_VERTEX_COUNT) {
+        throw std::length_error("Too many vertices");
+    }
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+        throw std::out_of_range("Edge vertex is out of range");
+    }
     edges_.push_back(edge);
-    const EdgeId id = edges_.size() - 1;
-    incidence_lists_.at(edge.from).push_back(id);
-    return id;
+    edge_offsets_.clear();
+    return edges_.size() - 1;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::AddVertices(size_t count) {
+    if (count > MAX_VERTEX_COUNT - vertex_count_) {
+        throw std::length_error("Too many vertices");
+    }
+    vertex_count_ += count;
+    edge_offsets_.clear();
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::RemoveEdge(EdgeId edge_id) {
+    if (edge_id >= edges_.size()) {
+        throw std::out_of_range("Edge is out of range");
+    }
+    removed_edges_.resize(edges_.size());
+    removed_edges_[edge_id] = true;
+    edge_offsets_.clear();
+}
+
+template <typename Weight>
+std::vector<EdgeId> DirectedWeightedGraph<Weight>::Freeze() {
+    removed_edges_.resize(edges_.size());
+    // Устойчивая сортировка подсчётом: порядок рёбер одной вершины сохраняется
+    edge_offsets_.assign(vertex_count_ + 1, 0);
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        if (!removed_edges_[edge_id]) {
+            ++edge_offsets_[edges_[edge_id].from + 1];
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        edge_offsets_[vertex + 1] += edge_offsets_[vertex];
+    }
+
+    std::vector<EdgeId> new_ids(edges_.size(), NO_EDGE_ID);
+    std::vector<EdgeId> next_position(edge_offsets_.begin(), edge_offsets_.end() - 1);
+    std::vector<Edge<Weight>> sorted_edges(edge_offsets_.back());
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        if (removed_edges_[edge_id]) {
+            continue;
+        }
+        const EdgeId new_id = next_position[edges_[edge_id].from]++;
+        new_ids[edge_id] = new_id;
+        sorted_edges[new_id] = edges_[edge_id];
+    }
+    edges_ = std::move(sorted_edges);
+    removed_edges_.clear();
+    return new_ids;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return !edge_offsets_.empty();
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return vertex_count_;
 }
 
 template <typename Weight>
@@ -66,12 +153,19 @@ size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
 
 template <typename Weight>
 const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-    return edges_.at(edge_id);
+    assert(edge_id < edges_.size());
+    return edges_[edge_id];
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    if (vertex >= vertex_count_) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+    if (edge_offsets_.empty()) {
+        throw std::logic_error("Graph should be frozen before traversal");
+    }
+    return ranges::AsIndexRange(edge_offsets_[vertex], edge_offsets_[vertex + 1]);
 }
-}  // namespace graph
\ No newline at end of file
+}  // namespace graph
@@ -1,8 +1,16 @@
 #include "json_reader.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <tuple>
 #include <vector>
 #include <sstream>
 
+#include "mapped_file.h"
+
 using namespace std;
 
 namespace reader {
@@ -97,29 +105,173 @@ int GetIdRequests(const json::Node& request) {
     return request.AsMap().at("id"s).AsInt();
 }
 
+router::RouterEngine ParseRouterEngine(const std::string& engine) {
+    if (engine == "all_pairs"s) {
+        return router::RouterEngine::ALL_PAIRS;
+    } else if (engine == "dijkstra"s) {
+        return router::RouterEngine::DIJKSTRA;
+    } else if (engine == "ch"s) {
+        return router::RouterEngine::CONTRACTION_HIERARCHY;
+    } else if (engine == "astar"s) {
+        return router::RouterEngine::ASTAR;
+    } else if (engine == "bidirectional_astar"s) {
+        return router::RouterEngine::BIDIRECTIONAL_ASTAR;
+    } else if (engine == "raptor"s) {
+        return router::RouterEngine::RAPTOR;
+    }
+    throw std::invalid_argument("Unknown router engine: "s + engine);
+}
+
+graph::HeapType ParseHeapType(const std::string& heap_type) {
+    if (heap_type == "binary"s) {
+        return graph::HeapType::BINARY;
+    } else if (heap_type == "radix"s) {
+        return graph::HeapType::RADIX;
+    }
+    throw std::invalid_argument("Unknown heap type: "s + heap_type);
+}
+
+router::GraphModel ParseGraphModel(const std::string& graph_model) {
+    if (graph_model == "complete"s) {
+        return router::GraphModel::COMPLETE;
+    } else if (graph_model == "linear"s) {
+        return router::GraphModel::LINEAR;
+    }
+    throw std::invalid_argument("Unknown graph model: "s + graph_model);
+}
+
+router::TableWeight ParseTableWeight(const std::string& table_weight) {
+    if (table_weight == "double"s) {
+        return router::TableWeight::DOUBLE;
+    } else if (table_weight == "float"s) {
+        return router::TableWeight::FLOAT;
+    } else if (table_weight == "fixed"s) {
+        return router::TableWeight::FIXED_POINT;
+    }
+    throw std::invalid_argument("Unknown route table weight: "s + table_weight);
+}
+
+graph::RelaxKernel ParseRelaxKernel(const std::string& kernel) {
+    if (kernel == "classic"s) {
+        return graph::RelaxKernel::CLASSIC;
+    } else if (kernel == "blocked"s) {
+        return graph::RelaxKernel::BLOCKED;
+    }
+    throw std::invalid_argument("Unknown all-pairs kernel: "s + kernel);
+}
+
+namespace {
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t hash) {
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+template <typename T>
+uint64_t HashValue(const T& value, uint64_t hash) {
+    return HashBytes(&value, sizeof(value), hash);
+}
+
+uint64_t HashString(const std::string& value, uint64_t hash) {
+    hash = HashValue(value.size(), hash);
+    return HashBytes(value.data(), value.size(), hash);
+}
+
+}  // namespace
+
+uint64_t HashNode(const json::Node& node, uint64_t hash) {
+    // Тег типа отличает, например, 1 от 1.0 и "1"
+    if (node.IsNull()) {
+        return HashValue('n', hash);
+    } else if (node.IsBool()) {
+        return HashValue(node.AsBool(), HashValue('b', hash));
+    } else if (node.IsInt()) {
+        return HashValue(node.AsInt(), HashValue('i', hash));
+    } else if (node.IsPureDouble()) {
+        return HashValue(node.AsDouble(), HashValue('d', hash));
+    } else if (node.IsString()) {
+        return HashString(node.AsString(), HashValue('s', hash));
+    } else if (node.IsArray()) {
+        hash = HashValue(node.AsArray().size(), HashValue('a', hash));
+        for (const auto& item : node.AsArray()) {
+            hash = HashNode(item, hash);
+        }
+        return hash;
+    }
+    hash = HashValue(node.AsMap().size(), HashValue('m', hash));
+    for (const auto& [key, value] : node.AsMap()) {
+        hash = HashNode(value, HashString(key, hash));
+    }
+    return hash;
+}
+
 JsonHandler::JsonHandler(std::istream& input, 
                 handler::RequestHandler& handler, 
-                map_renderer::MapRenderer& renderer)
+                map_renderer::MapRenderer& renderer,
+                RunMode mode)
         : handler_(handler), 
           renderer_(renderer),
-          document_(json::Load(input)) {
+          document_(json::Load(input)),
+          mode_(mode) {
+        if (mode_ == RunMode::EXPORT_SNAPSHOT) {
+            // Для записи снимка нужны только base_requests и путь к файлу
+            ProcessInput();
+            handler_.Freeze();
+            io::WriteFileAtomically(GetCatalogueFile(), [this](std::ostream& output) {
+                handler_.GetCatalogue().SaveSnapshot(output);
+            });
+            return;
+        }
         renderer_(ParseRenderSettings(document_));
-        ProcessInput();
-        router_ = std::make_unique<router::TransportRouter>(handler_.GetCatalogue(), ProcessRoutingSettings(GetRoutingSettings()));
+        const auto& stat_requests = GetStatRequests();
+        const bool has_updates = std::any_of(stat_requests.begin(), stat_requests.end(), [](const json::Node& request) {
+            return GetTypeRequests(request) == "Update"s;
+        });
+        if (mode_ == RunMode::IMPORT_SNAPSHOT) {
+            if (has_updates) {
+                throw std::invalid_argument("Update requests cannot change a catalogue snapshot"s);
+            }
+            handler_.LoadSnapshot(GetCatalogueFile());
+        } else {
+            // Каталог не замораживается: поиск по имени в изменяемых таблицах быстрее,
+            // чем в совершенных хеш-функциях снимка, а снимок нужен только для файла
+            ProcessInput();
+        }
+        router_ = std::make_unique<router::TransportRouter>(handler_.GetCatalogue(),
+                                                            ProcessRoutingSettings(GetRoutingSettings()),
+                                                            ProcessRouterFileSettings());
+        handler_.AddObserver(router_.get());
     }
 
+JsonHandler::~JsonHandler() {
+    handler_.RemoveObserver(router_.get());
+}
+
 void JsonHandler::ProcessInput(){
-    for (const auto& request : GetBaseRequests()) {
-        if (GetTypeRequests(request) == "Stop"s) {
+    ProcessBaseRequests(GetBaseRequests());
+}
+
+void JsonHandler::ProcessStopRequests(const json::Array& requests) {
+    for (const auto& request : requests) {
+        if (GetTypeRequests(request) == "Stop"s && !handler_.CheckStop(GetNameRequests(request))) {
             AddStop(request);
         }
     }
-    for (const auto& request : GetBaseRequests()) {
-        if (GetTypeRequests(request) == "Stop"s) {
+    for (const auto& request : requests) {
+        if (GetTypeRequests(request) == "Stop"s && request.AsMap().count("road_distances"s) > 0) {
             AddDistance(request);
         }
     }
-    for (const auto& request : GetBaseRequests()) {
+}
+
+void JsonHandler::ProcessBaseRequests(const json::Array& requests) {
+    ProcessStopRequests(requests);
+    for (const auto& request : requests) {
         if (GetTypeRequests(request) == "Bus"s) {
             AddBus(request);
         }
@@ -128,20 +280,43 @@ void JsonHandler::ProcessInput(){
 
     
 void JsonHandler::ProcessRenderMap(std::ostream& output) {
-    renderer_.RenderMap(handler_.GetAllStops(), handler_.GetAllBuses(), output);
+    renderer_.RenderMap(handler_.GetAllStops(), handler_.GetAllBuses(), handler_.GetCatalogue(), output);
 }
 
 void JsonHandler::ProcessOutput(std::ostream& output) {
+    if (mode_ == RunMode::EXPORT_SNAPSHOT) {
+        throw std::logic_error("No responses in export-snapshot mode"s);
+    }
     json::Builder builder;
     builder.StartArray();
         
-    for (const auto& request : GetStatRequests()) {           
+    const auto& requests = GetStatRequests();
+    std::vector<std::optional<router::RouteInfo>> routes(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const auto& request = requests[i];
+        // Граф меняется только запросами Update, маршруты между ними считаются одним пакетом
+        if (i == 0 || GetTypeRequests(requests[i - 1]) == "Update"s) {
+            BuildRouteBatch(requests, i, routes);
+        }
         if(GetTypeRequests(request) == "Bus"s) {
             GetInfoBus(request, builder);
         } else if(GetTypeRequests(request) == "Stop"s) {
             GetInfoStop(request, builder);
+        } else if(GetTypeRequests(request) == "Route"s && (request.AsMap().at("from"s).IsMap() || request.AsMap().at("to"s).IsMap())){
+            ProcessPointRouteRequest(request, builder);
         } else if(GetTypeRequests(request) == "Route"s){
-            ProcessRouteRequest(request, builder);
+            ProcessRouteRequest(request, routes[i], builder);
+            routes[i].reset();
+        } else if(GetTypeRequests(request) == "Matrix"s){
+            ProcessMatrixRequest(request, builder);
+        } else if(GetTypeRequests(request) == "Isochrone"s){
+            ProcessIsochroneRequest(request, builder);
+        } else if(GetTypeRequests(request) == "NearbyStops"s){
+            ProcessNearbyStopsRequest(request, builder);
+        } else if(GetTypeRequests(request) == "StopsInBox"s){
+            ProcessStopsInBoxRequest(request, builder);
+        } else if(GetTypeRequests(request) == "Update"s){
+            ProcessUpdateRequest(request, builder);
         } else {
             RenderMapResponse(request, builder);
         }
@@ -149,6 +324,10 @@ void JsonHandler::ProcessOutput(std::ostream& output) {
 
     builder.EndArray();
     json::Print(json::Document{builder.Build()}, output);
+
+    if (router_->GetRoutingSettings().log_stats) {
+        router_->ReportStats(std::cerr);
+    }
 }
     
 const json::Array& JsonHandler::GetBaseRequests() const {
@@ -162,14 +341,16 @@ const json::Array& JsonHandler::GetStatRequests() const {
 const json::Dict& JsonHandler::GetRoutingSettings() const {
     return document_.GetRoot().AsMap().at("routing_settings"s).AsMap();
 }
+
+const std::string& JsonHandler::GetCatalogueFile() const {
+    return document_.GetRoot().AsMap().at("serialization_settings"s).AsMap().at("catalogue_file"s).AsString();
+}
     
 void JsonHandler::AddStop (const json::Node& request) {
-    std::string name = GetNameRequests(request);
-        
     double lat = request.AsMap().at("latitude"s).AsDouble();
     double lng = request.AsMap().at("longitude"s).AsDouble();
         
-    handler_.AddStop(name, lat, lng);
+    handler_.AddStop(GetNameRequests(request), lat, lng);
 }
     
 void JsonHandler::AddDistance(const json::Node& request) { 
@@ -179,27 +360,22 @@ void JsonHandler::AddDistance(const json::Node& request) {
 }
 
 void JsonHandler::AddBus(const json::Node& request) {
-    std::string name = GetNameRequests(request);
     const auto& stops = request.AsMap().at("stops"s).AsArray();
-    std::vector<std::string> stop_names;
+    const bool is_roundtrip = request.AsMap().at("is_roundtrip"s).AsBool();
+    // Имена читаются прямо из документа, каталог скопирует их в свою арену
+    std::vector<std::string_view> stop_names;
+    stop_names.reserve(is_roundtrip || stops.empty() ? stops.size() : stops.size() * 2 - 1);
 
     for (const auto& stop : stops) {
         stop_names.push_back(stop.AsString());
     }
 
-    if(!request.AsMap().at("is_roundtrip"s).AsBool()) {
-        auto copy_stops = stop_names;
-        bool first = true;
-
-        for (auto it = copy_stops.rbegin(); it != copy_stops.rend(); ++it) {
-            if(first) {
-                first = false;
-                continue;
-            }
-            stop_names.push_back(*it);
+    if(!is_roundtrip && !stops.empty()) {
+        for (auto it = std::next(stops.rbegin()); it != stops.rend(); ++it) {
+            stop_names.push_back(it->AsString());
         }
     }
-    handler_.AddBus(name, stop_names, request.AsMap().at("is_roundtrip").AsBool());
+    handler_.AddBus(GetNameRequests(request), stop_names, is_roundtrip);
 }
 
 void JsonHandler::GetInfoBus(const json::Node& request, json::Builder& builder) {
@@ -224,7 +400,7 @@ void JsonHandler::GetInfoBus(const json::Node& request, json::Builder& builder)
 }
 
 void JsonHandler::GetInfoStop(const json::Node& request, json::Builder& builder) {
-    auto buses_to_stop = handler_.GetBusesByStop(GetNameRequests(request));
+    const auto buses_to_stop = handler_.GetBusesByStop(GetNameRequests(request));
     
     if(buses_to_stop.empty() && !handler_.CheckStop(GetNameRequests(request))) {
         builder.StartDict()
@@ -236,8 +412,8 @@ void JsonHandler::GetInfoStop(const json::Node& request, json::Builder& builder)
                .Key("request_id"s).Value(GetIdRequests(request))
                .Key("buses"s).StartArray();
         
-        for (const auto& bus_name : buses_to_stop) {
-            builder.Value(std::string(bus_name));
+        for (const domain::BusId bus : buses_to_stop) {
+            builder.Value(std::string(handler_.GetCatalogue().GetBus(bus).name));
         }
         
         builder.EndArray().EndDict();
@@ -246,7 +422,7 @@ void JsonHandler::GetInfoStop(const json::Node& request, json::Builder& builder)
     
 void JsonHandler::RenderMapResponse(const json::Node& request, json::Builder& builder) {
     std::ostringstream svg_output;
-    renderer_.RenderMap(handler_.GetAllStops(), handler_.GetAllBuses(), svg_output);
+    renderer_.RenderMap(handler_.GetAllStops(), handler_.GetAllBuses(), handler_.GetCatalogue(), svg_output);
     std::string svg_str = svg_output.str();
         
     builder.StartDict()
@@ -256,25 +432,117 @@ void JsonHandler::RenderMapResponse(const json::Node& request, json::Builder& bu
 }
 
     router::RoutingSettings JsonHandler::ProcessRoutingSettings(const json::Dict& routing_settings) const {
-        return {
-        routing_settings.at("bus_wait_time"s).AsInt(),
-        routing_settings.at("bus_velocity"s).AsDouble()
-        };
+        router::RoutingSettings settings;
+        settings.bus_wait_time = routing_settings.at("bus_wait_time"s).AsInt();
+        settings.bus_velocity = routing_settings.at("bus_velocity"s).AsDouble();
+
+        if (auto it = routing_settings.find("router_engine"s); it != routing_settings.end()) {
+            settings.engine = ParseRouterEngine(it->second.AsString());
+        }
+        if (auto it = routing_settings.find("graph_model"s); it != routing_settings.end()) {
+            settings.graph_model = ParseGraphModel(it->second.AsString());
+        }
+        // В модели linear вершин не число остановок, а остановки плюс сумма длин маршрутов:
+        // таблица all_pairs из V × V ячеек и предрасчёт за O(V³) вырастают на порядки
+        if (settings.engine == router::RouterEngine::ALL_PAIRS && settings.graph_model == router::GraphModel::LINEAR) {
+            throw std::invalid_argument("graph_model linear is not supported by the all_pairs engine");
+        }
+        if (auto it = routing_settings.find("dijkstra_heap"s); it != routing_settings.end()) {
+            settings.heap_type = ParseHeapType(it->second.AsString());
+        }
+        if (auto it = routing_settings.find("route_table_weight"s); it != routing_settings.end()) {
+            settings.table_weight = ParseTableWeight(it->second.AsString());
+        }
+        if (auto it = routing_settings.find("all_pairs_kernel"s); it != routing_settings.end()) {
+            settings.relax_kernel = ParseRelaxKernel(it->second.AsString());
+        }
+        if (auto it = routing_settings.find("precompute_threads"s); it != routing_settings.end()) {
+            if (it->second.AsInt() < 0) {
+                throw std::invalid_argument("precompute_threads should be non-negative");
+            }
+            settings.precompute_threads = static_cast<size_t>(it->second.AsInt());
+        }
+        if (auto it = routing_settings.find("route_cache_size"s); it != routing_settings.end()) {
+            if (it->second.AsInt() < 0) {
+                throw std::invalid_argument("route_cache_size should be non-negative");
+            }
+            settings.route_cache_size = static_cast<size_t>(it->second.AsInt());
+        }
+        if (auto it = routing_settings.find("log_stats"s); it != routing_settings.end()) {
+            settings.log_stats = it->second.AsBool();
+        }
+        if (auto it = routing_settings.find("walk_velocity"s); it != routing_settings.end()) {
+            if (it->second.AsDouble() <= 0.0) {
+                throw std::invalid_argument("walk_velocity should be positive");
+            }
+            settings.walk_velocity = it->second.AsDouble();
+        }
+        if (auto it = routing_settings.find("walk_radius"s); it != routing_settings.end()) {
+            if (it->second.AsDouble() < 0.0) {
+                throw std::invalid_argument("walk_radius should be non-negative");
+            }
+            settings.walk_radius = it->second.AsDouble();
+        }
+        return settings;
     }
     
-    void JsonHandler::ProcessRouteRequest(const json::Node& request, json::Builder& builder) {
-    const auto& from = request.AsMap().at("from"s).AsString();
-    const auto& to = request.AsMap().at("to"s).AsString();
+    std::optional<router::RouterFileSettings> JsonHandler::ProcessRouterFileSettings() const {
+        const auto& root = document_.GetRoot().AsMap();
+        const auto settings_it = root.find("serialization_settings"s);
+        if (settings_it == root.end()) {
+            return std::nullopt;
+        }
+        const auto file_it = settings_it->second.AsMap().find("router_file"s);
+        if (file_it == settings_it->second.AsMap().end()) {
+            return std::nullopt;
+        }
 
-    if (!handler_.CheckStop(from) || !handler_.CheckStop(to)) {
-        builder.StartDict()
-            .Key("request_id"s).Value(request.AsMap().at("id"s).AsInt())
-            .Key("error_message"s).Value("not found"s)
-            .EndDict();
-        return;
+        // Ключ зависит только от того, что влияет на граф и таблицу маршрутов
+        json::Dict routing_settings = GetRoutingSettings();
+        routing_settings.erase("log_stats"s);
+        routing_settings.erase("precompute_threads"s);
+        routing_settings.erase("route_cache_size"s);
+        routing_settings.erase("walk_velocity"s);
+        routing_settings.erase("walk_radius"s);
+        // Каталог из снимка задаётся контрольной суммой файла вместо base_requests
+        uint64_t key = mode_ == RunMode::IMPORT_SNAPSHOT ? handler_.GetCatalogue().GetSnapshotChecksum()
+                                                         : HashNode(root.at("base_requests"s));
+        key = HashNode(json::Node{std::move(routing_settings)}, key);
+        return router::RouterFileSettings{file_it->second.AsString(), key};
     }
 
-    auto route = router_->BuildRoute(from, to, handler_.GetCatalogue());
+    void JsonHandler::BuildRouteBatch(const json::Array& requests, size_t first,
+                                      std::vector<std::optional<router::RouteInfo>>& routes) const {
+        // Индексы запросов и остановки назначения для каждой остановки отправления
+        std::map<std::string, std::pair<std::vector<size_t>, std::vector<std::string>>> batches;
+        for (size_t i = first; i < requests.size() && GetTypeRequests(requests[i]) != "Update"s; ++i) {
+            // Маршруты от точки и до точки считаются отдельно
+            if (GetTypeRequests(requests[i]) != "Route"s || !requests[i].AsMap().at("from"s).IsString()
+                || !requests[i].AsMap().at("to"s).IsString()) {
+                continue;
+            }
+            const auto& from = requests[i].AsMap().at("from"s).AsString();
+            const auto& to = requests[i].AsMap().at("to"s).AsString();
+            if (!handler_.CheckStop(from) || !handler_.CheckStop(to)) {
+                continue;
+            }
+            auto& [indexes, targets] = batches[from];
+            indexes.push_back(i);
+            targets.push_back(to);
+        }
+
+        for (const auto& [from, batch] : batches) {
+            const auto& [indexes, targets] = batch;
+            auto batch_routes = router_->BuildRoutes(from, targets, handler_.GetCatalogue());
+            for (size_t j = 0; j < indexes.size(); ++j) {
+                routes[indexes[j]] = std::move(batch_routes[j]);
+            }
+        }
+    }
+
+    void JsonHandler::ProcessRouteRequest(const json::Node& request, const std::optional<router::RouteInfo>& route,
+                                          json::Builder& builder) {
+    // Маршрут не построен, если остановки нет в каталоге или она недостижима
     if (!route) {
         builder.StartDict()
             .Key("request_id"s).Value(request.AsMap().at("id"s).AsInt())
@@ -283,18 +551,39 @@ void JsonHandler::RenderMapResponse(const json::Node& request, json::Builder& bu
         return;
     }
         
-    const auto& [full_time, edges] = *route;
     builder.StartDict()
-        .Key("request_id"s).Value(request.AsMap().at("id"s).AsInt())
-        .Key("total_time"s).Value(full_time)
+        .Key("request_id"s).Value(request.AsMap().at("id"s).AsInt());
+    AddRouteItems(*route, builder);
+    // Маршруты с меньшим числом пересадок, но дольше быстрейшего
+    if (auto it = request.AsMap().find("alternatives"s); it != request.AsMap().end() && it->second.AsBool()) {
+        builder.Key("alternatives"s).StartArray();
+        for (const auto& alternative : router_->BuildAlternatives(request.AsMap().at("from"s).AsString(),
+                                                                  request.AsMap().at("to"s).AsString(),
+                                                                  handler_.GetCatalogue())) {
+            builder.StartDict();
+            AddRouteItems(alternative, builder);
+            builder.EndDict();
+        }
+        builder.EndArray();
+    }
+    builder.EndDict();
+}
+
+    void JsonHandler::AddRouteItems(const router::RouteInfo& route, json::Builder& builder) {
+    const auto& [full_time, rides] = route;
+    builder.Key("total_time"s).Value(full_time)
         .Key("items"s).StartArray();
+    AddRideItems(rides, builder);
+    builder.EndArray();
+}
 
-    for (const auto& edge : edges) {
+    void JsonHandler::AddRideItems(const std::vector<router::RideInfo>& rides, json::Builder& builder) {
+    for (const auto& ride : rides) {
         const auto& [index_from, 
                      index_to, 
                      time, 
                      bus_name, 
-                     stop_count] = edge;
+                     stop_count] = ride;
 
             builder.StartDict()
             .Key("stop_name"s).Value(static_cast<std::string>(handler_.GetStopToIndex(index_from)))
@@ -310,9 +599,227 @@ void JsonHandler::RenderMapResponse(const json::Node& request, json::Builder& bu
             .Key("bus"s).Value(static_cast<std::string>(bus_name))
             .EndDict();
     }
-
-    builder.EndArray()
-        .EndDict();
 }
+
+    void JsonHandler::ProcessPointRouteRequest(const json::Node& request, json::Builder& builder) {
+        const auto& catalogue = handler_.GetCatalogue();
+        const double walk_radius = router_->GetRoutingSettings().walk_radius;
+        // Точка конца маршрута и остановки, до которых от неё можно дойти; nullopt — остановки нет
+        const auto find_endpoint = [&](const json::Node& endpoint)
+            -> std::optional<std::pair<geo::Coordinates, std::vector<spatial::NearbyStop>>> {
+            if (endpoint.IsString()) {
+                const domain::Stop* stop = catalogue.FindStop(endpoint.AsString());
+                if (stop == nullptr) {
+                    return std::nullopt;
+                }
+                return std::pair{stop->coord, std::vector<spatial::NearbyStop>{{stop->id, 0.0}}};
+            }
+            const geo::Coordinates point{endpoint.AsMap().at("latitude"s).AsDouble(),
+                                         endpoint.AsMap().at("longitude"s).AsDouble()};
+            return std::pair{point, GetSpatialIndex().FindNearest(point, std::numeric_limits<size_t>::max(), walk_radius)};
+        };
+        const auto from = find_endpoint(request.AsMap().at("from"s));
+        const auto to = find_endpoint(request.AsMap().at("to"s));
+
+        std::optional<router::PointRouteInfo> route;
+        if (from && to) {
+            // У совпадающих точек арккосинус может получить аргумент чуть больше единицы
+            double direct_distance = geo::ComputeDistance(from->first, to->first);
+            direct_distance = std::isnan(direct_distance) ? 0.0 : direct_distance;
+            route = router_->BuildPointRoute(from->second, to->second,
+                                             direct_distance <= walk_radius ? std::optional<double>{direct_distance} : std::nullopt,
+                                             catalogue);
+        }
+        if (!route) {
+            builder.StartDict()
+                   .Key("request_id"s).Value(GetIdRequests(request))
+                   .Key("error_message"s).Value("not found"s)
+                   .EndDict();
+            return;
+        }
+
+        const auto add_walk = [&builder](const std::optional<router::WalkInfo>& walk) {
+            if (walk) {
+                builder.StartDict()
+                       .Key("type"s).Value("Walk"s)
+                       .Key("time"s).Value(walk->time)
+                       .Key("distance"s).Value(walk->distance)
+                       .EndDict();
+            }
+        };
+        builder.StartDict()
+               .Key("request_id"s).Value(GetIdRequests(request))
+               .Key("total_time"s).Value(route->full_time)
+               .Key("items"s).StartArray();
+        add_walk(route->walk_to_stop);
+        AddRideItems(route->rides, builder);
+        add_walk(route->walk_from_stop);
+        builder.EndArray().EndDict();
+    }
     
+    void JsonHandler::ProcessMatrixRequest(const json::Node& request, json::Builder& builder) {
+        const auto to_names = [](const json::Node& stops) {
+            std::vector<std::string> names;
+            for (const auto& stop : stops.AsArray()) {
+                names.push_back(stop.AsString());
+            }
+            return names;
+        };
+        const auto sources = to_names(request.AsMap().at("sources"s));
+        const auto targets = to_names(request.AsMap().at("targets"s));
+        for (const auto* stops : {&sources, &targets}) {
+            for (const auto& stop : *stops) {
+                if (!handler_.CheckStop(stop)) {
+                    builder.StartDict()
+                           .Key("request_id"s).Value(GetIdRequests(request))
+                           .Key("error_message"s).Value("not found"s)
+                           .EndDict();
+                    return;
+                }
+            }
+        }
+
+        builder.StartDict()
+               .Key("request_id"s).Value(GetIdRequests(request))
+               .Key("times"s).StartArray();
+        for (const auto& time : router_->BuildTimeMatrix(sources, targets, handler_.GetCatalogue())) {
+            builder.Value(time ? json::Node::Value{*time} : json::Node::Value{nullptr});
+        }
+        builder.EndArray();
+
+        if (const auto it = request.AsMap().find("with_paths"s); it != request.AsMap().end() && it->second.AsBool()) {
+            builder.Key("routes"s).StartArray();
+            for (const auto& source : sources) {
+                for (const auto& route : router_->BuildRoutes(source, targets, handler_.GetCatalogue())) {
+                    if (!route) {
+                        builder.Value(nullptr);
+                        continue;
+                    }
+                    builder.StartDict();
+                    AddRouteItems(*route, builder);
+                    builder.EndDict();
+                }
+            }
+            builder.EndArray();
+        }
+        builder.EndDict();
+    }
+
+    void JsonHandler::ProcessIsochroneRequest(const json::Node& request, json::Builder& builder) {
+        const auto& from = request.AsMap().at("from"s).AsString();
+        if (!handler_.CheckStop(from)) {
+            builder.StartDict()
+                   .Key("request_id"s).Value(GetIdRequests(request))
+                   .Key("error_message"s).Value("not found"s)
+                   .EndDict();
+            return;
+        }
+
+        const double max_time = request.AsMap().at("max_time"s).AsDouble();
+        const auto& catalogue = handler_.GetCatalogue();
+        std::vector<std::pair<const domain::Stop*, double>> reachable_stops;
+        for (const auto& [stop_index, time] : router_->FindReachableStops(from, max_time, catalogue)) {
+            reachable_stops.emplace_back(&catalogue.GetStop(static_cast<domain::StopId>(stop_index)), time);
+        }
+        // Равные по времени остановки упорядочены по названию, чтобы ответ не зависел от порядка обхода
+        std::sort(reachable_stops.begin(), reachable_stops.end(), [](const auto& lhs, const auto& rhs) {
+            return std::tie(lhs.second, lhs.first->name) < std::tie(rhs.second, rhs.first->name);
+        });
+
+        builder.StartDict()
+               .Key("request_id"s).Value(GetIdRequests(request))
+               .Key("stops"s).StartArray();
+        for (const auto& [stop, time] : reachable_stops) {
+            builder.StartDict()
+                   .Key("stop_name"s).Value(std::string(stop->name))
+                   .Key("time"s).Value(time)
+                   .EndDict();
+        }
+        builder.EndArray();
+
+        if (const auto it = request.AsMap().find("render_map"s); it != request.AsMap().end() && it->second.AsBool()) {
+            std::ostringstream svg_output;
+            renderer_.RenderIsochrone(handler_.GetAllStops(), handler_.GetAllBuses(), handler_.GetCatalogue(),
+                                      reachable_stops, max_time, svg_output);
+            builder.Key("map"s).Value(svg_output.str());
+        }
+        builder.EndDict();
+    }
+
+    const spatial::SpatialIndex& JsonHandler::GetSpatialIndex() {
+        if (!spatial_index_) {
+            spatial_index_ = std::make_unique<spatial::SpatialIndex>(handler_.GetCatalogue());
+        }
+        return *spatial_index_;
+    }
+
+    void JsonHandler::ProcessNearbyStopsRequest(const json::Node& request, json::Builder& builder) {
+        const auto& fields = request.AsMap();
+        const geo::Coordinates point{fields.at("latitude"s).AsDouble(), fields.at("longitude"s).AsDouble()};
+        const auto count_it = fields.find("count"s);
+        const auto radius_it = fields.find("radius"s);
+        const size_t count = count_it == fields.end() ? std::numeric_limits<size_t>::max()
+                                                      : static_cast<size_t>(std::max(count_it->second.AsInt(), 0));
+        const double radius = radius_it == fields.end() ? spatial::SpatialIndex::NO_LIMIT : radius_it->second.AsDouble();
+
+        const auto& catalogue = handler_.GetCatalogue();
+        auto nearby_stops = GetSpatialIndex().FindNearest(point, count, radius);
+        // Равноудалённые остановки упорядочены по названию, как в ответе Isochrone
+        std::stable_sort(nearby_stops.begin(), nearby_stops.end(), [&catalogue](const auto& lhs, const auto& rhs) {
+            return std::tie(lhs.distance, catalogue.GetStop(lhs.id).name)
+                 < std::tie(rhs.distance, catalogue.GetStop(rhs.id).name);
+        });
+
+        builder.StartDict()
+               .Key("request_id"s).Value(GetIdRequests(request))
+               .Key("stops"s).StartArray();
+        for (const auto& [id, distance] : nearby_stops) {
+            builder.StartDict()
+                   .Key("stop_name"s).Value(std::string(catalogue.GetStop(id).name))
+                   .Key("distance"s).Value(distance)
+                   .EndDict();
+        }
+        builder.EndArray().EndDict();
+    }
+
+    void JsonHandler::ProcessStopsInBoxRequest(const json::Node& request, json::Builder& builder) {
+        const auto& fields = request.AsMap();
+        const geo::Coordinates min{fields.at("min_latitude"s).AsDouble(), fields.at("min_longitude"s).AsDouble()};
+        const geo::Coordinates max{fields.at("max_latitude"s).AsDouble(), fields.at("max_longitude"s).AsDouble()};
+
+        const auto& catalogue = handler_.GetCatalogue();
+        std::vector<std::string_view> names;
+        for (const domain::StopId id : GetSpatialIndex().FindInBox(min, max)) {
+            names.push_back(catalogue.GetStop(id).name);
+        }
+        std::sort(names.begin(), names.end());
+
+        builder.StartDict()
+               .Key("request_id"s).Value(GetIdRequests(request))
+               .Key("stops"s).StartArray();
+        for (const std::string_view name : names) {
+            builder.Value(std::string(name));
+        }
+        builder.EndArray().EndDict();
+    }
+
+    void JsonHandler::ProcessUpdateRequest(const json::Node& request, json::Builder& builder) {
+        const auto& requests = request.AsMap().at("base_requests"s).AsArray();
+        // Остановки не удаляются, поэтому их можно добавить заранее, а автобусы
+        // добавляются и удаляются в порядке запросов: [RemoveBus X, Bus X] пересоздаёт X
+        ProcessStopRequests(requests);
+        spatial_index_.reset();
+        for (const auto& update : requests) {
+            if (GetTypeRequests(update) == "Bus"s) {
+                AddBus(update);
+            } else if (GetTypeRequests(update) == "RemoveBus"s) {
+                handler_.RemoveBus(GetNameRequests(update));
+            }
+        }
+        router_->ApplyChanges(handler_.GetCatalogue());
+
+        builder.StartDict()
+               .Key("request_id"s).Value(GetIdRequests(request))
+               .EndDict();
+    }
 }
\ No newline at end of file
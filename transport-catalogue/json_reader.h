@@ -1,13 +1,17 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <variant>
+#include <vector>
 
 #include "json.h"
 #include "json_builder.h"
 #include "request_handler.h"
 #include "map_renderer.h"
+#include "spatial_index.h"
 #include "transport_router.h"
 
 namespace reader{
@@ -49,11 +53,37 @@ const std::string& GetNameRequests(const json::Node& request);
 
 int GetIdRequests(const json::Node& request);
 
+router::RouterEngine ParseRouterEngine(const std::string& engine);
+
+graph::HeapType ParseHeapType(const std::string& heap_type);
+
+router::GraphModel ParseGraphModel(const std::string& graph_model);
+
+router::TableWeight ParseTableWeight(const std::string& table_weight);
+
+graph::RelaxKernel ParseRelaxKernel(const std::string& kernel);
+
+// Откуда берётся каталог и что делается с запросами
+enum class RunMode {
+    // Каталог из base_requests, ответы на stat_requests
+    PROCESS_REQUESTS,
+    // Каталог из base_requests записывается в serialization_settings.catalogue_file, ответов нет
+    EXPORT_SNAPSHOT,
+    // Каталог из файла serialization_settings.catalogue_file, base_requests не читаются
+    IMPORT_SNAPSHOT,
+};
+
+// 64-битный FNV-1a хеш JSON-узла с учётом типов значений и структуры
+uint64_t HashNode(const json::Node& node, uint64_t hash = 14695981039346656037ull);
+
 class JsonHandler {
 public:
     JsonHandler(std::istream& input, 
                 handler::RequestHandler& handler, 
-                map_renderer::MapRenderer& renderer);
+                map_renderer::MapRenderer& renderer,
+                RunMode mode = RunMode::PROCESS_REQUESTS);
+
+    ~JsonHandler();
     
     void ProcessInput();
     
@@ -65,12 +95,22 @@ private:
     handler::RequestHandler& handler_;
     map_renderer::MapRenderer& renderer_;
     json::Document document_;
+    RunMode mode_;
+    // Не строится в режиме EXPORT_SNAPSHOT
     std::unique_ptr<router::TransportRouter> router_;
+    // Строится при первом пространственном запросе и сбрасывается запросом Update
+    std::unique_ptr<spatial::SpatialIndex> spatial_index_;
     
     const json::Array& GetBaseRequests() const;
     const json::Array& GetStatRequests() const;
     const json::Dict& GetRoutingSettings() const;
+    const std::string& GetCatalogueFile() const;
     
+    // Остановки, затем расстояния; существующие остановки не пересоздаются
+    void ProcessStopRequests(const json::Array& requests);
+    // Остановки и расстояния, затем автобусы
+    void ProcessBaseRequests(const json::Array& requests);
+
     void AddStop (const json::Node& request);
     void AddDistance(const json::Node& request);
     void AddBus(const json::Node& request);
@@ -81,8 +121,45 @@ private:
     void RenderMapResponse(const json::Node& request, json::Builder& builder);
     
     router::RoutingSettings ProcessRoutingSettings(const json::Dict& routing_settings) const;
+
+    // Настройки файла маршрутизатора из serialization_settings.router_file, если он задан
+    std::optional<router::RouterFileSettings> ProcessRouterFileSettings() const;
     
-    void ProcessRouteRequest(const json::Node& request, json::Builder& builder);
+    // Считает маршруты запросов Route из requests[first..], до ближайшего Update,
+    // группируя их по остановке отправления; результат кладёт в routes по индексу запроса
+    void BuildRouteBatch(const json::Array& requests, size_t first, std::vector<std::optional<router::RouteInfo>>& routes) const;
+
+    void ProcessRouteRequest(const json::Node& request, const std::optional<router::RouteInfo>& route, json::Builder& builder);
+
+    // Ключи total_time и items ответа с маршрутом
+    void AddRouteItems(const router::RouteInfo& route, json::Builder& builder);
+    // Элементы Wait и Bus поездок в открытый массив items
+    void AddRideItems(const std::vector<router::RideInfo>& rides, json::Builder& builder);
+
+    // Маршрут Route, у которого from или to — точка {latitude, longitude}: пешком до одной
+    // из остановок в пределах walk_radius, на автобусах и пешком от остановки, или пешком целиком
+    void ProcessPointRouteRequest(const json::Node& request, json::Builder& builder);
+
+    // Матрица времён в пути sources × targets построчно (null — маршрута нет);
+    // при with_paths: true в routes в том же порядке добавляются сами маршруты
+    void ProcessMatrixRequest(const json::Node& request, json::Builder& builder);
+
+    // Остановки, достижимые из from не дольше чем за max_time минут; при render_map: true
+    // к ответу добавляется карта с выделенными остановками
+    void ProcessIsochroneRequest(const json::Node& request, json::Builder& builder);
+
+    const spatial::SpatialIndex& GetSpatialIndex();
+
+    // Ближайшие к точке latitude, longitude остановки: не больше count и не дальше radius метров,
+    // если они заданы, по возрастанию расстояния
+    void ProcessNearbyStopsRequest(const json::Node& request, json::Builder& builder);
+
+    // Названия остановок в прямоугольнике min_latitude..max_latitude × min_longitude..max_longitude
+    void ProcessStopsInBoxRequest(const json::Node& request, json::Builder& builder);
+
+    // Изменение каталога: base_requests в формате исходных данных и RemoveBus.
+    // Автобусы добавляются и удаляются в порядке элементов
+    void ProcessUpdateRequest(const json::Node& request, json::Builder& builder);
 };
     
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+// Кэш ограниченного размера с вытеснением давно не использованных записей (LRU).
+// Записи хранятся в списке от самой свежей к самой старой, хеш-таблица указывает на узлы списка.
+// При capacity == 0 кэш ничего не хранит.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity = 0)
+        : capacity_(capacity) {
+    }
+
+    // Возвращает запись и делает её самой свежей или nullptr, если записи нет
+    const Value* Find(const Key& key) {
+        const auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++miss_count_;
+            return nullptr;
+        }
+        ++hit_count_;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return &it->second->second;
+    }
+
+    // Добавляет или заменяет запись, вытесняя самую старую при переполнении
+    void Insert(const Key& key, Value value) {
+        if (capacity_ == 0) {
+            return;
+        }
+        if (const auto it = index_.find(key); it != index_.end()) {
+            it->second->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return;
+        }
+        if (entries_.size() == capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        entries_.emplace_front(key, std::move(value));
+        index_.emplace(key, entries_.begin());
+    }
+
+    void Clear() {
+        index_.clear();
+        entries_.clear();
+    }
+
+    size_t GetSize() const {
+        return entries_.size();
+    }
+
+    size_t GetCapacity() const {
+        return capacity_;
+    }
+
+    size_t GetHitCount() const {
+        return hit_count_;
+    }
+
+    size_t GetMissCount() const {
+        return miss_count_;
+    }
+
+private:
+    using Entry = std::pair<Key, Value>;
+
+    size_t capacity_ = 0;
+    std::list<Entry> entries_;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+    size_t hit_count_ = 0;
+    size_t miss_count_ = 0;
+};
+
+}  // namespace cache
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <string_view>
 
 #include "transport_catalogue.h"
 #include "request_handler.h"
@@ -6,13 +7,28 @@
 #include "map_renderer.h"
 #include "transport_router.h"
 
-int main(){
+int main(int argc, char* argv[]){
+    using namespace std::literals;
+
+    // Без аргументов — каталог из base_requests и ответы на stat_requests
+    reader::RunMode mode = reader::RunMode::PROCESS_REQUESTS;
+    if (argc == 2 && argv[1] == "export-snapshot"sv) {
+        mode = reader::RunMode::EXPORT_SNAPSHOT;
+    } else if (argc == 2 && argv[1] == "import-snapshot"sv) {
+        mode = reader::RunMode::IMPORT_SNAPSHOT;
+    } else if (argc != 1) {
+        std::cerr << "Usage: transport_catalogue [export-snapshot | import-snapshot]"sv << std::endl;
+        return 1;
+    }
+
     catalogue::TransportCatalogue catalogue;
     map_renderer::MapRenderer renderer;
     handler::RequestHandler handler(catalogue);
-    reader::JsonHandler json_handler(std::cin, handler, renderer);
+    reader::JsonHandler json_handler(std::cin, handler, renderer, mode);
 
-    json_handler.ProcessOutput(std::cout);
+    if (mode != reader::RunMode::EXPORT_SNAPSHOT) {
+        json_handler.ProcessOutput(std::cout);
+    }
     
     return 0;
-}
\ No newline at end of file
+}
@@ -96,10 +96,27 @@ class MapRenderer {
 public:
     void operator()(RenderSettings settings);
 
-    template <typename StopsRange, typename BusesRange>
-    void RenderMap(const StopsRange& stops, const BusesRange& buses, std::ostream& output) {
-        RenderBusLines(buses, stops);
-        RenderBusLabels(buses, stops);
+    // Остановки автобусов заданы id; stop_index.GetStop(id) возвращает остановку по id
+    template <typename StopsRange, typename BusesRange, typename StopIndex>
+    void RenderMap(const StopsRange& stops, const BusesRange& buses, const StopIndex& stop_index, std::ostream& output) {
+        doc_.Clear();
+        RenderBusLines(buses, stops, stop_index);
+        RenderBusLabels(buses, stops, stop_index);
+        RenderStopCircles(stops);
+        RenderStopLabels(stops);
+        doc_.Render(output);
+    }
+
+    // Карта с выделенными остановками изохроны: под кружком каждой достижимой остановки
+    // рисуется круг цвета палитры, номер цвета растёт с долей потраченного времени
+    template <typename StopsRange, typename BusesRange, typename StopIndex>
+    void RenderIsochrone(const StopsRange& stops, const BusesRange& buses, const StopIndex& stop_index,
+                         const std::vector<std::pair<const domain::Stop*, double>>& reachable_stops,
+                         double max_time, std::ostream& output) {
+        doc_.Clear();
+        RenderBusLines(buses, stops, stop_index);
+        RenderBusLabels(buses, stops, stop_index);
+        RenderReachableStops(stops, reachable_stops, max_time);
         RenderStopCircles(stops);
         RenderStopLabels(stops);
         doc_.Render(output);
@@ -110,8 +127,8 @@ private:
     svg::Document doc_;
     
     // Рендеринг линий маршрутов
-    template <typename BusesRange, typename StopsRange>
-    void RenderBusLines(const BusesRange& buses, const StopsRange& stops) {
+    template <typename BusesRange, typename StopsRange, typename StopIndex>
+    void RenderBusLines(const BusesRange& buses, const StopsRange& stops, const StopIndex& stop_index) {
         using namespace std;
         
         SphereProjector projector(stops.begin(), stops.end(), settings_.width, settings_.height, settings_.padding);
@@ -127,8 +144,8 @@ private:
                     .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
                     .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
             
-            for (const auto& stop : bus->stops) {
-                polyline.AddPoint(projector(stop->coord));
+            for (const domain::StopId stop : bus->stops) {
+                polyline.AddPoint(projector(stop_index.GetStop(stop).coord));
             }
 
             doc_.Add(polyline);
@@ -138,8 +155,8 @@ private:
     
     void RenderBusLabel(svg::Point stop_point, const std::string& bus_name, const svg::Color& color);
     
-    template <typename BusesRange, typename StopsRange>
-    void RenderBusLabels(const BusesRange& buses, const StopsRange& stops)  {
+    template <typename BusesRange, typename StopsRange, typename StopIndex>
+    void RenderBusLabels(const BusesRange& buses, const StopsRange& stops, const StopIndex& stop_index)  {
         SphereProjector projector(stops.begin(), stops.end(), settings_.width, settings_.height, settings_.padding);
         size_t color_idx = 0;
 
@@ -148,14 +165,14 @@ private:
 
             auto bus_back = bus->stops[bus->stops.size()/2];
         
-            svg::Point first_stop = projector(bus->stops.front()->coord);
-            svg::Point last_stop = projector(bus_back->coord);
+            svg::Point first_stop = projector(stop_index.GetStop(bus->stops.front()).coord);
+            svg::Point last_stop = projector(stop_index.GetStop(bus_back).coord);
             svg::Color bus_color = settings_.color_palette[color_idx % settings_.color_palette.size()];
         
-            RenderBusLabel(first_stop, bus_name.data(), bus_color);
+            RenderBusLabel(first_stop, std::string(bus_name), bus_color);
 
             if (!bus->is_roundtrip && bus->stops.front() != bus_back) {
-                RenderBusLabel(last_stop, bus_name.data(), bus_color);
+                RenderBusLabel(last_stop, std::string(bus_name), bus_color);
             }
         
             ++color_idx;
@@ -166,7 +183,7 @@ private:
     void RenderStopCircles(const StopsRange& stops) {
         SphereProjector projector(stops.begin(), stops.end(), settings_.width, settings_.height, settings_.padding);
     
-        std::vector<domain::Stop*> sorted_stops(stops.begin(), stops.end());
+        std::vector<const domain::Stop*> sorted_stops(stops.begin(), stops.end());
         std::sort(sorted_stops.begin(), sorted_stops.end(), [](const auto* lhs, const auto* rhs) {
             return lhs->name < rhs->name;
         });
@@ -182,11 +199,29 @@ private:
         }
     }
     
+    template <typename StopsRange>
+    void RenderReachableStops(const StopsRange& stops,
+                              const std::vector<std::pair<const domain::Stop*, double>>& reachable_stops,
+                              double max_time) {
+        SphereProjector projector(stops.begin(), stops.end(), settings_.width, settings_.height, settings_.padding);
+        const size_t band_count = settings_.color_palette.size();
+
+        for (const auto& [stop, time] : reachable_stops) {
+            const size_t band = IsZero(max_time) ? 0
+                              : std::min(band_count - 1, static_cast<size_t>(time / max_time * band_count));
+            svg::Circle circle;
+            circle.SetCenter(projector(stop->coord))
+              .SetRadius(settings_.stop_radius * 2)
+              .SetFillColor(settings_.color_palette[band]);
+            doc_.Add(circle);
+        }
+    }
+
     template <typename StopsRange>
     void RenderStopLabels(const StopsRange& stops) {
         SphereProjector projector(stops.begin(), stops.end(), settings_.width, settings_.height, settings_.padding);
     
-        std::vector<domain::Stop*> sorted_stops(stops.begin(), stops.end());
+        std::vector<const domain::Stop*> sorted_stops(stops.begin(), stops.end());
         std::sort(sorted_stops.begin(), sorted_stops.end(), [](const auto* lhs, const auto* rhs) {
             return lhs->name < rhs->name;
         });
@@ -200,7 +235,7 @@ private:
                   .SetOffset(settings_.stop_label_offset)
                   .SetFontSize(settings_.stop_label_font_size)
                   .SetFontFamily("Verdana"s)
-                  .SetData(stop->name);
+                  .SetData(std::string(stop->name));
         
             svg::Text label = underlayer;
             label.SetFillColor("black"s);
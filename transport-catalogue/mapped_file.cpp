@@ -0,0 +1,84 @@
+#include "mapped_file.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TRANSPORT_CATALOGUE_HAS_MMAP
+#endif
+
+namespace io {
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef TRANSPORT_CATALOGUE_HAS_MMAP
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    struct stat file_stat {};
+    if (::fstat(descriptor, &file_stat) != 0) {
+        ::close(descriptor);
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ > 0) {
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data != MAP_FAILED) {
+            data_ = static_cast<const char*>(data);
+            mapped_ = true;
+        }
+    }
+    ::close(descriptor);
+    if (mapped_ || size_ == 0) {
+        return;
+    }
+#endif
+    // Запасной путь: чтение файла в буфер
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() {
+#ifdef TRANSPORT_CATALOGUE_HAS_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+const char* MappedFile::GetData() const {
+    return data_;
+}
+
+size_t MappedFile::GetSize() const {
+    return size_;
+}
+
+bool MappedFile::IsMapped() const {
+    return mapped_;
+}
+
+void ReplaceFile(const std::string& temporary_path, const std::string& path) {
+    if (std::rename(temporary_path.c_str(), path.c_str()) == 0) {
+        return;
+    }
+    // Не во всех системах rename заменяет существующий файл
+    std::remove(path.c_str());
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        std::remove(temporary_path.c_str());
+        throw std::runtime_error("Cannot replace file: " + path);
+    }
+}
+
+}  // namespace io
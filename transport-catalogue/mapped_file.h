@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace io {
+
+// Файл, доступный только для чтения как непрерывный блок памяти.
+// В POSIX-системах файл отображается в память через mmap и читается лениво,
+// на остальных платформах он целиком считывается в буфер.
+class MappedFile {
+public:
+    // Бросает std::runtime_error, если файл не удаётся открыть
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    const char* GetData() const;
+    size_t GetSize() const;
+    // true, если данные отображены в память, а не скопированы в буфер
+    bool IsMapped() const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> buffer_;
+};
+
+// Заменяет path файлом temporary_path
+void ReplaceFile(const std::string& temporary_path, const std::string& path);
+
+// Записывает файл через временный path + ".tmp" и переименование, чтобы читатели
+// никогда не видели файл записанным наполовину. writer получает std::ostream&.
+template <typename Writer>
+void WriteFileAtomically(const std::string& path, Writer writer) {
+    const std::string temporary_path = path + ".tmp";
+    {
+        std::ofstream output(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            throw std::runtime_error("Cannot open file for writing: " + temporary_path);
+        }
+        writer(output);
+        output.flush();
+        if (!output) {
+            throw std::runtime_error("Cannot write file: " + temporary_path);
+        }
+    }
+    ReplaceFile(temporary_path, path);
+}
+
+}  // namespace io
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "route_table.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace graph {
+
+// Ядро (min, +) для строки таблицы маршрутов:
+//   dst_weights[j] = min(dst_weights[j], through_weight + src_weights[j]),
+// при улучшении в dst_edges[j] копируется src_edges[j].
+// Для float используется AVX2 или SSE2, для double — SSE2, если они доступны при сборке,
+// иначе и для uint32_t — скалярный цикл.
+template <typename StoredWeight>
+void MinPlusRow(StoredWeight through_weight, const StoredWeight* src_weights, const uint32_t* src_edges,
+                StoredWeight* dst_weights, uint32_t* dst_edges, size_t count) {
+    using Traits = StoredWeightTraits<StoredWeight>;
+    for (size_t j = 0; j < count; ++j) {
+        const StoredWeight candidate_weight = Traits::Add(through_weight, src_weights[j]);
+        if (candidate_weight < dst_weights[j]) {
+            dst_weights[j] = candidate_weight;
+            dst_edges[j] = src_edges[j];
+        }
+    }
+}
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+
+// С AVX2 для double остаётся общий цикл: компилятор сам векторизует его маскированными
+// записями, и он не медленнее ручного ядра (benchmark/router_benchmark.cpp)
+#if !defined(__AVX2__)
+template <>
+inline void MinPlusRow<double>(double through_weight, const double* src_weights, const uint32_t* src_edges,
+                               double* dst_weights, uint32_t* dst_edges, size_t count) {
+    size_t j = 0;
+    const __m128d through = _mm_set1_pd(through_weight);
+    for (; j + 2 <= count; j += 2) {
+        const __m128d candidate = _mm_add_pd(through, _mm_loadu_pd(src_weights + j));
+        const __m128d current = _mm_loadu_pd(dst_weights + j);
+        const __m128d less = _mm_cmplt_pd(candidate, current);
+        if (_mm_movemask_pd(less) != 0) {
+            _mm_storeu_pd(dst_weights + j, _mm_or_pd(_mm_and_pd(less, candidate), _mm_andnot_pd(less, current)));
+            // Два 64-битных слова маски — в младшие 32-битные дорожки под два ребра
+            const __m128i less_bits = _mm_shuffle_epi32(_mm_castpd_si128(less), _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128i old_edges = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(dst_edges + j));
+            const __m128i new_edges = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_edges + j));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst_edges + j),
+                             _mm_or_si128(_mm_and_si128(less_bits, new_edges), _mm_andnot_si128(less_bits, old_edges)));
+        }
+    }
+    for (; j < count; ++j) {
+        const double candidate_weight = through_weight + src_weights[j];
+        if (candidate_weight < dst_weights[j]) {
+            dst_weights[j] = candidate_weight;
+            dst_edges[j] = src_edges[j];
+        }
+    }
+}
+#endif
+
+template <>
+inline void MinPlusRow<float>(float through_weight, const float* src_weights, const uint32_t* src_edges,
+                              float* dst_weights, uint32_t* dst_edges, size_t count) {
+    size_t j = 0;
+#if defined(__AVX2__)
+    const __m256 through = _mm256_set1_ps(through_weight);
+    for (; j + 8 <= count; j += 8) {
+        const __m256 candidate = _mm256_add_ps(through, _mm256_loadu_ps(src_weights + j));
+        const __m256 current = _mm256_loadu_ps(dst_weights + j);
+        const __m256 less = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+        if (_mm256_movemask_ps(less) != 0) {
+            _mm256_storeu_ps(dst_weights + j, _mm256_blendv_ps(current, candidate, less));
+            const __m256 edges = _mm256_blendv_ps(
+                _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst_edges + j))),
+                _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_edges + j))),
+                less);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst_edges + j), _mm256_castps_si256(edges));
+        }
+    }
+#else
+    const __m128 through = _mm_set1_ps(through_weight);
+    for (; j + 4 <= count; j += 4) {
+        const __m128 candidate = _mm_add_ps(through, _mm_loadu_ps(src_weights + j));
+        const __m128 current = _mm_loadu_ps(dst_weights + j);
+        const __m128 less = _mm_cmplt_ps(candidate, current);
+        if (_mm_movemask_ps(less) != 0) {
+            _mm_storeu_ps(dst_weights + j, _mm_or_ps(_mm_and_ps(less, candidate), _mm_andnot_ps(less, current)));
+            const __m128i less_bits = _mm_castps_si128(less);
+            const __m128i old_edges = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst_edges + j));
+            const __m128i new_edges = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_edges + j));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_edges + j),
+                             _mm_or_si128(_mm_and_si128(less_bits, new_edges), _mm_andnot_si128(less_bits, old_edges)));
+        }
+    }
+#endif
+    for (; j < count; ++j) {
+        const float candidate_weight = through_weight + src_weights[j];
+        if (candidate_weight < dst_weights[j]) {
+            dst_weights[j] = candidate_weight;
+            dst_edges[j] = src_edges[j];
+        }
+    }
+}
+
+#endif
+
+}  // namespace graph
@@ -0,0 +1,44 @@
+#include "parallel.h"
+
+#include <algorithm>
+
+namespace parallel {
+
+size_t ResolveThreadCount(size_t requested, size_t task_count) {
+    size_t thread_count = requested;
+    if (thread_count == 0) {
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        thread_count = hardware_threads == 0 ? 1 : hardware_threads;
+    }
+    return std::max<size_t>(std::min(thread_count, task_count), 1);
+}
+
+Barrier::Barrier(size_t thread_count)
+    : thread_count_(thread_count) {
+}
+
+void Barrier::ArriveAndWait() {
+    std::unique_lock lock(mutex_);
+    const size_t generation = generation_;
+    if (++waiting_ == thread_count_) {
+        waiting_ = 0;
+        ++generation_;
+        condition_.notify_all();
+        return;
+    }
+    condition_.wait(lock, [this, generation] {
+        return generation != generation_;
+    });
+}
+
+void Barrier::ArriveAndDrop() {
+    std::lock_guard lock(mutex_);
+    --thread_count_;
+    if (waiting_ > 0 && waiting_ == thread_count_) {
+        waiting_ = 0;
+        ++generation_;
+        condition_.notify_all();
+    }
+}
+
+}  // namespace parallel
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// Возвращает число потоков для расчёта из task_count независимых частей (строк таблицы,
+// автобусов): 0 означает «по числу ядер», и потоков не больше, чем частей, но хотя бы один
+size_t ResolveThreadCount(size_t requested, size_t task_count);
+
+// Точка синхронизации фиксированного числа потоков, допускает повторное использование
+class Barrier {
+public:
+    explicit Barrier(size_t thread_count);
+
+    void ArriveAndWait();
+
+    // Поток выходит из числа участников: текущий и следующие шаги его не ждут
+    void ArriveAndDrop();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    size_t thread_count_;
+    size_t waiting_ = 0;
+    size_t generation_ = 0;
+};
+
+namespace detail {
+
+template <typename Body>
+void RunInThreads(size_t thread_count, Barrier* barrier, Body& body) {
+    std::vector<std::exception_ptr> errors(thread_count);
+    auto guarded_body = [&body, &errors, barrier](size_t thread_index) {
+        try {
+            body(thread_index);
+        } catch (...) {
+            errors[thread_index] = std::current_exception();
+            // Остальные потоки не должны ждать на барьере поток, который уже не придёт
+            if (barrier != nullptr) {
+                barrier->ArriveAndDrop();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count > 0 ? thread_count - 1 : 0);
+    for (size_t thread_index = 1; thread_index < thread_count; ++thread_index) {
+        threads.emplace_back(guarded_body, thread_index);
+    }
+    if (thread_count > 0) {
+        guarded_body(0);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace detail
+
+// Запускает body(thread_index) в thread_count потоках и дожидается их завершения.
+// Нулевой индекс выполняется в вызывающем потоке. Первое исключение пробрасывается
+// после завершения всех потоков.
+template <typename Body>
+void RunInThreads(size_t thread_count, Body body) {
+    detail::RunInThreads(thread_count, nullptr, body);
+}
+
+// То же для потоков, которые синхронизируются барьером barrier на thread_count участников:
+// поток, завершившийся исключением, выходит из барьера, и остальные доходят до конца
+template <typename Body>
+void RunInThreads(size_t thread_count, Barrier& barrier, Body body) {
+    detail::RunInThreads(thread_count, &barrier, body);
+}
+
+}  // namespace parallel
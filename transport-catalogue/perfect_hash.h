@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "flat_hash_map.h"
+
+namespace containers {
+
+// Хеш строки словами по 8 байт, перемешанный финализатором MixHash. В отличие от std::hash
+// не зависит от стандартной библиотеки, поэтому годится для таблиц, сохраняемых в файл;
+// от порядка байтов машины зависит, как и сами такие файлы
+inline uint64_t HashString(std::string_view str) {
+    constexpr uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+    uint64_t hash = 14695981039346656037ULL ^ str.size();
+    size_t position = 0;
+    for (; position + sizeof(uint64_t) <= str.size(); position += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, str.data() + position, sizeof(uint64_t));
+        hash = (hash ^ word) * MULTIPLIER;
+        hash ^= hash >> 29;
+    }
+    uint64_t tail = 0;
+    if (position < str.size()) {
+        std::memcpy(&tail, str.data() + position, str.size() - position);
+    }
+    return MixHash((hash ^ tail) * MULTIPLIER);
+}
+
+// Минимальная совершенная хеш-функция по схеме hash and displace: n различных ключей
+// переводятся в различные ячейки 0..n-1. Ключи делятся по корзинам, и для каждой корзины
+// подобрана затравка, при которой все её ключи попадают в свободные ячейки. Хранятся только
+// затравки корзин, около 1.3 байта на ключ; поиск ячейки — одно чтение затравки.
+// Ключ не из набора тоже попадает в какую-то ячейку, так что ключ ячейки нужно сравнить
+// с искомым: что хранить в ячейках, решает владелец таблицы.
+// Объект не владеет затравками: они лежат в векторе Tables или в отображённом файле
+class PerfectHash {
+public:
+    static constexpr uint32_t NO_KEY = static_cast<uint32_t>(-1);
+
+    // Затравки корзин и номер ключа в каждой ячейке
+    struct Tables {
+        std::vector<uint32_t> seeds;
+        std::vector<uint32_t> keys;
+    };
+
+    // Таблицы для набора различных ключей. Бросает std::invalid_argument, если у двух ключей совпали хеши,
+    // в том числе если среди ключей есть повторы
+    static Tables Build(const std::vector<std::string_view>& keys) {
+        const size_t key_count = keys.size();
+        if (key_count >= NO_KEY) {
+            throw std::length_error("Too many keys for a perfect hash");
+        }
+        Tables tables{std::vector<uint32_t>(GetBucketCount(key_count), 0),
+                      std::vector<uint32_t>(key_count, NO_KEY)};
+        if (key_count == 0) {
+            return tables;
+        }
+        const size_t bucket_count = tables.seeds.size();
+        std::vector<uint64_t> hashes(key_count);
+        // Ключи, отсортированные по корзинам: ключи корзины b — [bucket_offsets[b], bucket_offsets[b + 1])
+        std::vector<uint32_t> bucket_offsets(bucket_count + 1, 0);
+        for (size_t key = 0; key < key_count; ++key) {
+            hashes[key] = HashString(keys[key]);
+            ++bucket_offsets[GetBucket(hashes[key], bucket_count) + 1];
+        }
+        std::partial_sum(bucket_offsets.begin(), bucket_offsets.end(), bucket_offsets.begin());
+        std::vector<uint32_t> bucket_keys(key_count);
+        std::vector<uint32_t> positions(bucket_offsets.begin(), bucket_offsets.end() - 1);
+        for (uint32_t key = 0; key < key_count; ++key) {
+            bucket_keys[positions[GetBucket(hashes[key], bucket_count)]++] = key;
+        }
+
+        // Большие корзины размещаются первыми, пока свободных ячеек много
+        std::vector<uint32_t> buckets(bucket_count);
+        std::iota(buckets.begin(), buckets.end(), 0);
+        std::stable_sort(buckets.begin(), buckets.end(), [&bucket_offsets](uint32_t lhs, uint32_t rhs) {
+            return bucket_offsets[lhs + 1] - bucket_offsets[lhs] > bucket_offsets[rhs + 1] - bucket_offsets[rhs];
+        });
+        std::vector<uint32_t> slots;
+        for (const uint32_t bucket : buckets) {
+            const uint32_t begin = bucket_offsets[bucket];
+            const uint32_t end = bucket_offsets[bucket + 1];
+            if (begin == end) {
+                break;
+            }
+            // Ключи с равными хешами попадают в одну ячейку при любой затравке
+            for (uint32_t i = begin; i < end; ++i) {
+                for (uint32_t j = begin; j < i; ++j) {
+                    if (hashes[bucket_keys[i]] == hashes[bucket_keys[j]]) {
+                        throw std::invalid_argument("Perfect hash keys should be distinct");
+                    }
+                }
+            }
+            for (uint32_t seed = 0;; ++seed) {
+                if (seed == NO_KEY) {
+                    throw std::runtime_error("Perfect hash seed not found");
+                }
+                slots.clear();
+                for (uint32_t i = begin; i < end; ++i) {
+                    const uint32_t slot = GetSlot(hashes[bucket_keys[i]], seed, key_count);
+                    if (tables.keys[slot] != NO_KEY || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+                if (slots.size() == end - begin) {
+                    tables.seeds[bucket] = seed;
+                    for (uint32_t i = begin; i < end; ++i) {
+                        tables.keys[slots[i - begin]] = bucket_keys[i];
+                    }
+                    break;
+                }
+            }
+        }
+        return tables;
+    }
+
+    // Число затравок для key_count ключей
+    static size_t GetBucketCount(size_t key_count) {
+        return key_count / KEYS_PER_BUCKET + 1;
+    }
+
+    PerfectHash() = default;
+    PerfectHash(const uint32_t* seeds, size_t bucket_count, size_t key_count)
+        : seeds_(seeds)
+        , bucket_count_(bucket_count)
+        , key_count_(key_count) {
+    }
+
+    // Ячейка ключа с хешем HashString(key) или NO_KEY для пустого набора
+    uint32_t Find(uint64_t hash) const {
+        if (key_count_ == 0) {
+            return NO_KEY;
+        }
+        return GetSlot(hash, seeds_[GetBucket(hash, bucket_count_)], key_count_);
+    }
+
+private:
+    static constexpr size_t KEYS_PER_BUCKET = 3;
+
+    // Корзина — по старшим битам хеша, ячейка — по перемешанному с затравкой хешу;
+    // x * n >> 32 переводит 32-битное число в диапазон [0, n) без деления
+    static uint32_t GetBucket(uint64_t hash, size_t bucket_count) {
+        return static_cast<uint32_t>(((hash >> 32) * bucket_count) >> 32);
+    }
+
+    static uint32_t GetSlot(uint64_t hash, uint32_t seed, size_t key_count) {
+        const uint64_t mixed = MixHash(hash + seed * 0x9e3779b97f4a7c15ULL);
+        return static_cast<uint32_t>(((mixed >> 32) * key_count) >> 32);
+    }
+
+    const uint32_t* seeds_ = nullptr;
+    size_t bucket_count_ = 0;
+    size_t key_count_ = 0;
+};
+
+}  // namespace containers
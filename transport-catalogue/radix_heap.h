@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Монотонная radix-куча: извлекаемые ключи не убывают, что выполняется для Дейкстры
+// с неотрицательными весами. Неотрицательные double упорядочены так же, как их битовое
+// представление, поэтому ключ переводится в uint64_t без потери порядка.
+template <typename Key, typename Value>
+class RadixHeap {
+public:
+    void Push(Key key, Value value) {
+        const uint64_t bits = ToBits(key);
+        if (bits < last_) {
+            throw std::logic_error("RadixHeap keys should be monotone");
+        }
+        buckets_[BucketIndex(bits)].push_back({bits, key, std::move(value)});
+        ++size_;
+    }
+
+    // Извлекает элемент с минимальным ключом
+    std::pair<Key, Value> Pop() {
+        if (buckets_[0].empty()) {
+            size_t index = 1;
+            while (buckets_[index].empty()) {
+                ++index;
+            }
+            auto& bucket = buckets_[index];
+            uint64_t new_last = bucket.front().bits;
+            for (const auto& item : bucket) {
+                new_last = std::min(new_last, item.bits);
+            }
+            last_ = new_last;
+            for (auto& item : bucket) {
+                buckets_[BucketIndex(item.bits)].push_back(std::move(item));
+            }
+            bucket.clear();
+        }
+        Item item = std::move(buckets_[0].back());
+        buckets_[0].pop_back();
+        --size_;
+        return {item.key, std::move(item.value)};
+    }
+
+    bool Empty() const {
+        return size_ == 0;
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+private:
+    struct Item {
+        uint64_t bits;
+        Key key;
+        Value value;
+    };
+
+    static constexpr size_t BUCKET_COUNT = 65;
+
+    static uint64_t ToBits(Key key) {
+        if constexpr (std::is_floating_point_v<Key>) {
+            static_assert(sizeof(Key) <= sizeof(uint64_t));
+            // +0.0 и -0.0 должны давать один ключ
+            const Key normalized = key + Key{0};
+            if constexpr (sizeof(Key) == sizeof(uint64_t)) {
+                uint64_t bits;
+                std::memcpy(&bits, &normalized, sizeof(bits));
+                return bits;
+            } else {
+                uint32_t bits;
+                std::memcpy(&bits, &normalized, sizeof(bits));
+                return bits;
+            }
+        } else {
+            return static_cast<uint64_t>(key);
+        }
+    }
+
+    size_t BucketIndex(uint64_t bits) const {
+        const uint64_t diff = bits ^ last_;
+        if (diff == 0) {
+            return 0;
+        }
+#if defined(__GNUC__) || defined(__clang__)
+        return BUCKET_COUNT - 1 - static_cast<size_t>(__builtin_clzll(diff));
+#else
+        size_t index = 0;
+        for (uint64_t rest = diff; rest != 0; rest >>= 1) {
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    std::array<std::vector<Item>, BUCKET_COUNT> buckets_;
+    uint64_t last_ = 0;
+    size_t size_ = 0;
+};
+
+}  // namespace graph
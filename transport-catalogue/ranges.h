@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cstddef>
 #include <iterator>
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace ranges {
 
@@ -33,4 +35,124 @@ auto AsRange(const C& container) {
     return Range{container.begin(), container.end()};
 }
 
+// Непрерывный массив только для чтения: указатель и длина, как std::span из C++20.
+// Данные массиву не принадлежат. Интерфейс повторяет std::vector, чтобы заменять его в полях
+template <typename T>
+class Span {
+public:
+    Span() = default;
+    Span(const T* data, size_t size)
+        : data_(data)
+        , size_(size) {
+    }
+    Span(const std::vector<T>& values)
+        : data_(values.data())
+        , size_(values.size()) {
+    }
+
+    const T* begin() const {
+        return data_;
+    }
+    const T* end() const {
+        return data_ + size_;
+    }
+    const T* data() const {
+        return data_;
+    }
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    const T& operator[](size_t index) const {
+        return data_[index];
+    }
+    const T& front() const {
+        return data_[0];
+    }
+    const T& back() const {
+        return data_[size_ - 1];
+    }
+
+private:
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Итератор по последовательным индексам [begin, end) без хранения самих индексов
+template <typename Index>
+class IndexIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Index;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Index*;
+    using reference = Index;
+
+    IndexIterator() = default;
+    explicit IndexIterator(Index index)
+        : index_(index) {
+    }
+
+    Index operator*() const {
+        return index_;
+    }
+    Index operator[](difference_type offset) const {
+        return index_ + offset;
+    }
+    IndexIterator& operator++() {
+        ++index_;
+        return *this;
+    }
+    IndexIterator operator++(int) {
+        IndexIterator copy = *this;
+        ++index_;
+        return copy;
+    }
+    IndexIterator& operator--() {
+        --index_;
+        return *this;
+    }
+    IndexIterator operator--(int) {
+        IndexIterator copy = *this;
+        --index_;
+        return copy;
+    }
+    IndexIterator& operator+=(difference_type offset) {
+        index_ += offset;
+        return *this;
+    }
+    IndexIterator& operator-=(difference_type offset) {
+        index_ -= offset;
+        return *this;
+    }
+    IndexIterator operator+(difference_type offset) const {
+        return IndexIterator(index_ + offset);
+    }
+    IndexIterator operator-(difference_type offset) const {
+        return IndexIterator(index_ - offset);
+    }
+    difference_type operator-(const IndexIterator& other) const {
+        return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+    }
+    bool operator==(const IndexIterator& other) const {
+        return index_ == other.index_;
+    }
+    bool operator!=(const IndexIterator& other) const {
+        return index_ != other.index_;
+    }
+    bool operator<(const IndexIterator& other) const {
+        return index_ < other.index_;
+    }
+
+private:
+    Index index_{};
+};
+
+template <typename Index>
+auto AsIndexRange(Index begin, Index end) {
+    return Range{IndexIterator<Index>(begin), IndexIterator<Index>(end)};
+}
+
 }  // namespace ranges
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace router {
+
+    RaptorRouter::RaptorRouter(const catalogue::TransportCatalogue& catalogue, int bus_wait_time, double meters_per_minute)
+        : bus_wait_time_(bus_wait_time)
+        , meters_per_minute_(meters_per_minute) {
+        const size_t stop_count = catalogue.GetStopCount();
+        std::vector<size_t> route_counts(stop_count + 1, 0);
+        for (const auto& [bus_name, bus] : catalogue.GetAllBuses()) {
+            if (bus->stops.size() < 2) {
+                continue;
+            }
+            Route route{bus_name, {}, {}};
+            route.stops.reserve(bus->stops.size());
+            route.distances.reserve(bus->stops.size());
+            for (size_t i = 0; i < bus->stops.size(); ++i) {
+                route.stops.push_back(bus->stops[i]);
+                route.distances.push_back(bus->road_distances[i]);
+                ++route_counts[route.stops.back() + 1];
+            }
+            routes_.push_back(std::move(route));
+        }
+
+        stop_route_offsets_.assign(stop_count + 1, 0);
+        for (size_t stop = 0; stop < stop_count; ++stop) {
+            stop_route_offsets_[stop + 1] = stop_route_offsets_[stop] + route_counts[stop + 1];
+        }
+        stop_routes_.resize(stop_route_offsets_.back());
+        std::vector<size_t> next_position(stop_route_offsets_.begin(), stop_route_offsets_.end() - 1);
+        for (uint32_t route_index = 0; route_index < routes_.size(); ++route_index) {
+            const auto& stops = routes_[route_index].stops;
+            for (uint32_t position = 0; position < stops.size(); ++position) {
+                stop_routes_[next_position[stops[position]]++] = {route_index, position};
+            }
+        }
+    }
+
+    std::vector<std::optional<RouteInfo>> RaptorRouter::BuildRoutes(size_t from, const std::vector<size_t>& targets) const {
+        const Rounds rounds = Search({{from, 0.0}}, targets.size() == 1 ? targets.front() : NO_STOP, UNREACHED_TIME);
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(targets.size());
+        for (const size_t to : targets) {
+            const auto round = FindLastRound(rounds, to);
+            routes.push_back(round ? std::optional<RouteInfo>{ExtractRoute(rounds, to, *round)} : std::nullopt);
+        }
+        return routes;
+    }
+
+    std::vector<RouteInfo> RaptorRouter::BuildAlternatives(size_t from, size_t to) const {
+        const Rounds rounds = Search({{from, 0.0}}, to, UNREACHED_TIME);
+        std::vector<RouteInfo> routes;
+        // Время до цели выставляется в раунде, только если оно строго лучше прежнего
+        for (size_t round = 0; round < rounds.times.size(); ++round) {
+            if (to < rounds.times[round].size() && rounds.times[round][to] != UNREACHED_TIME) {
+                routes.push_back(ExtractRoute(rounds, to, round));
+            }
+        }
+        return routes;
+    }
+
+    std::vector<std::optional<double>> RaptorRouter::FindArrivalTimes(size_t from, double time_limit) const {
+        const Rounds rounds = Search({{from, 0.0}}, NO_STOP, time_limit);
+        std::vector<std::optional<double>> times(stop_route_offsets_.size() - 1);
+        for (size_t stop = 0; stop < times.size(); ++stop) {
+            if (const auto round = FindLastRound(rounds, stop)) {
+                times[stop] = rounds.times[*round][stop];
+            }
+        }
+        return times;
+    }
+
+    std::optional<std::pair<size_t, RouteInfo>> RaptorRouter::BuildMultiStopRoute(
+        const std::vector<std::pair<size_t, double>>& sources, const std::vector<std::pair<size_t, double>>& targets) const {
+        const Rounds rounds = Search(sources, NO_STOP, UNREACHED_TIME);
+        double best_total = UNREACHED_TIME;
+        size_t best_stop = NO_STOP;
+        size_t best_round = 0;
+        // Раунды просматриваются по возрастанию, так что при равном времени остаётся меньше поездок
+        for (const auto& [stop, final_time] : targets) {
+            for (size_t round = 0; round < rounds.times.size(); ++round) {
+                const double time = rounds.times[round].at(stop);
+                if (time != UNREACHED_TIME && time + final_time < best_total) {
+                    best_total = time + final_time;
+                    best_stop = stop;
+                    best_round = round;
+                }
+            }
+        }
+        if (best_stop == NO_STOP) {
+            return std::nullopt;
+        }
+        RouteInfo route = ExtractRoute(rounds, best_stop, best_round);
+        route.full_time = best_total;
+        return std::pair{best_stop, std::move(route)};
+    }
+
+    RaptorRouter::Rounds RaptorRouter::Search(const std::vector<std::pair<size_t, double>>& sources, size_t target,
+                                              double time_limit) const {
+        const size_t stop_count = stop_route_offsets_.size() - 1;
+        if (target != NO_STOP && target >= stop_count) {
+            throw std::out_of_range("Stop is out of range");
+        }
+        for (const auto& [from, _] : sources) {
+            if (from >= stop_count) {
+                throw std::out_of_range("Stop is out of range");
+            }
+        }
+        ++query_count_;
+
+        Rounds rounds;
+        rounds.times.emplace_back(stop_count, UNREACHED_TIME);
+        rounds.labels.emplace_back(stop_count);
+        if (time_limit < 0.0) {
+            return rounds;
+        }
+
+        // Лучшее время за все раунды и время на конец прошлого раунда, с которого можно сесть
+        std::vector<double> best_times(stop_count, UNREACHED_TIME);
+        std::vector<size_t> marked_stops;
+        std::vector<bool> is_marked(stop_count, false);
+        for (const auto& [from, time] : sources) {
+            if (time <= time_limit && time < best_times[from]) {
+                best_times[from] = time;
+                rounds.times[0][from] = time;
+                if (!is_marked[from]) {
+                    is_marked[from] = true;
+                    marked_stops.push_back(from);
+                }
+            }
+        }
+        for (const size_t stop : marked_stops) {
+            is_marked[stop] = false;
+        }
+        std::vector<double> previous_times = best_times;
+        // Самая ранняя позиция маршрута с улучшенной остановкой
+        std::vector<uint32_t> first_positions(routes_.size(), NO_POSITION);
+        std::vector<uint32_t> queued_routes;
+
+        while (!marked_stops.empty()) {
+            for (const size_t stop : marked_stops) {
+                for (size_t i = stop_route_offsets_[stop]; i < stop_route_offsets_[stop + 1]; ++i) {
+                    const auto [route_index, position] = stop_routes_[i];
+                    if (first_positions[route_index] == NO_POSITION) {
+                        queued_routes.push_back(route_index);
+                    }
+                    first_positions[route_index] = std::min(first_positions[route_index], position);
+                }
+            }
+            marked_stops.clear();
+
+            const size_t round = rounds.times.size();
+            rounds.times.emplace_back(stop_count, UNREACHED_TIME);
+            rounds.labels.emplace_back(stop_count);
+            ++round_count_;
+
+            for (const uint32_t route_index : queued_routes) {
+                const Route& route = routes_[route_index];
+                uint32_t board_position = NO_POSITION;
+                for (uint32_t position = first_positions[route_index]; position < route.stops.size(); ++position) {
+                    const uint32_t stop = route.stops[position];
+                    ++scanned_stop_count_;
+                    if (board_position != NO_POSITION) {
+                        const double arrival = previous_times[route.stops[board_position]]
+                                             + ComputeRideTime(route, board_position, position);
+                        const double bound = target == NO_STOP ? best_times[stop]
+                                                               : std::min(best_times[stop], best_times[target]);
+                        if (arrival < bound && arrival <= time_limit) {
+                            best_times[stop] = arrival;
+                            rounds.times[round][stop] = arrival;
+                            rounds.labels[round][stop] = {route_index, board_position, position};
+                            if (!is_marked[stop]) {
+                                is_marked[stop] = true;
+                                marked_stops.push_back(stop);
+                            }
+                        }
+                    }
+                    // Все рейсы одинаковы, поэтому садиться выгоднее там, откуда раньше доберёмся дальше
+                    if (previous_times[stop] != UNREACHED_TIME
+                        && (board_position == NO_POSITION
+                            || previous_times[stop] < previous_times[route.stops[board_position]]
+                                                      + ComputeTravelTime(route, board_position, position))) {
+                        board_position = position;
+                    }
+                }
+                first_positions[route_index] = NO_POSITION;
+            }
+            queued_routes.clear();
+
+            for (const size_t stop : marked_stops) {
+                previous_times[stop] = best_times[stop];
+                is_marked[stop] = false;
+            }
+        }
+        // Последний раунд ничего не улучшил
+        rounds.times.pop_back();
+        rounds.labels.pop_back();
+        return rounds;
+    }
+
+    RouteInfo RaptorRouter::ExtractRoute(const Rounds& rounds, size_t to, size_t round) const {
+        RouteInfo route{rounds.times[round][to], {}};
+        size_t stop = to;
+        while (round > 0) {
+            // Время остановки могло быть выставлено в одном из более ранних раундов
+            while (rounds.times[round][stop] == UNREACHED_TIME) {
+                --round;
+            }
+            if (round == 0) {
+                break;
+            }
+            const Label& label = rounds.labels[round][stop];
+            const Route& bus_route = routes_[label.route];
+            const size_t board_stop = bus_route.stops[label.board_position];
+            route.rides.push_back({board_stop, stop, ComputeRideTime(bus_route, label.board_position, label.alight_position),
+                                   bus_route.bus_name, static_cast<int>(label.alight_position - label.board_position)});
+            stop = board_stop;
+            --round;
+        }
+        std::reverse(route.rides.begin(), route.rides.end());
+        return route;
+    }
+
+    std::optional<size_t> RaptorRouter::FindLastRound(const Rounds& rounds, size_t stop) {
+        for (size_t round = rounds.times.size(); round > 0; --round) {
+            if (rounds.times[round - 1].at(stop) != UNREACHED_TIME) {
+                return round - 1;
+            }
+        }
+        return std::nullopt;
+    }
+
+    double RaptorRouter::ComputeTravelTime(const Route& route, uint32_t board_position, uint32_t alight_position) const {
+        return (route.distances[alight_position] - route.distances[board_position]) / meters_per_minute_;
+    }
+
+    double RaptorRouter::ComputeRideTime(const Route& route, uint32_t board_position, uint32_t alight_position) const {
+        // Тот же порядок операций, что и при построении рёбер графа
+        return bus_wait_time_ + ComputeTravelTime(route, board_position, alight_position);
+    }
+
+    size_t RaptorRouter::GetMemoryUsage() const {
+        size_t memory_usage = routes_.capacity() * sizeof(Route)
+                            + stop_route_offsets_.capacity() * sizeof(size_t)
+                            + stop_routes_.capacity() * sizeof(std::pair<uint32_t, uint32_t>);
+        for (const Route& route : routes_) {
+            memory_usage += route.stops.capacity() * sizeof(uint32_t) + route.distances.capacity() * sizeof(double);
+        }
+        return memory_usage;
+    }
+
+    void RaptorRouter::PrintStats(std::ostream& output) const {
+        output << "raptor: routes=" << routes_.size()
+               << " queries=" << query_count_
+               << " avg_rounds=" << (query_count_ == 0 ? 0.0 : static_cast<double>(round_count_) / query_count_)
+               << " avg_scanned_stops=" << (query_count_ == 0 ? 0.0 : static_cast<double>(scanned_stop_count_) / query_count_)
+               << std::endl;
+    }
+
+}  // namespace router
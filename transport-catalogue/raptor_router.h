@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "route_info.h"
+#include "transport_catalogue.h"
+
+namespace router {
+
+// Поиск по раундам (RAPTOR) прямо по последовательностям остановок автобусов, без графа.
+// Раунд k находит лучшее время прибытия на остановки ровно с k посадками: каждый автобус,
+// проходящий через улучшенную в прошлом раунде остановку, просматривается один раз
+// от самой ранней такой остановки до конца. Время каждой поездки считается так же,
+// как вес ребра полного графа, поэтому времена совпадают с графовыми движками.
+class RaptorRouter {
+public:
+    // meters_per_minute — скорость автобуса в метрах в минуту
+    RaptorRouter(const catalogue::TransportCatalogue& catalogue, int bus_wait_time, double meters_per_minute);
+
+    // Быстрейшие маршруты из from в каждую из targets; при равном времени — с меньшим числом поездок
+    std::vector<std::optional<RouteInfo>> BuildRoutes(size_t from, const std::vector<size_t>& targets) const;
+
+    // Маршруты, оптимальные по Парето по числу поездок и времени: каждый следующий
+    // на одну или несколько поездок длиннее и строго быстрее предыдущего
+    std::vector<RouteInfo> BuildAlternatives(size_t from, size_t to) const;
+
+    // Время до каждой остановки, достижимой не дольше чем за time_limit; nullopt — недостижима
+    std::vector<std::optional<double>> FindArrivalTimes(size_t from, double time_limit) const;
+
+    // Быстрейший маршрут из нескольких остановок в несколько и его конечная остановка:
+    // пары (остановка, время) задают время до начальной остановки и после конечной,
+    // full_time включает оба. Все начальные остановки попадают в нулевой раунд одного поиска
+    std::optional<std::pair<size_t, RouteInfo>> BuildMultiStopRoute(const std::vector<std::pair<size_t, double>>& sources,
+                                                                    const std::vector<std::pair<size_t, double>>& targets) const;
+
+    size_t GetMemoryUsage() const;
+
+    void PrintStats(std::ostream& output) const;
+
+private:
+    static constexpr double UNREACHED_TIME = std::numeric_limits<double>::infinity();
+    static constexpr uint32_t NO_POSITION = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t NO_STOP = std::numeric_limits<size_t>::max();
+
+    struct Route {
+        std::string_view bus_name;
+        std::vector<uint32_t> stops;
+        // Расстояние от начала маршрута до каждой позиции
+        std::vector<double> distances;
+    };
+
+    // Как достигнута остановка в раунде: автобус, позиции посадки и высадки
+    struct Label {
+        uint32_t route = NO_POSITION;
+        uint32_t board_position = 0;
+        uint32_t alight_position = 0;
+    };
+
+    // Время и метка каждой остановки по раундам; время выставлено, только если
+    // остановка улучшена в этом раунде
+    struct Rounds {
+        std::vector<std::vector<double>> times;
+        std::vector<std::vector<Label>> labels;
+    };
+
+    // Поиск из остановок sources с заданными начальными временами. target задаёт отсечение
+    // по уже найденному времени до цели, time_limit — по бюджету
+    Rounds Search(const std::vector<std::pair<size_t, double>>& sources, size_t target, double time_limit) const;
+    RouteInfo ExtractRoute(const Rounds& rounds, size_t to, size_t round) const;
+    // Последний раунд, в котором улучшено время до остановки, или nullopt
+    static std::optional<size_t> FindLastRound(const Rounds& rounds, size_t stop);
+    double ComputeTravelTime(const Route& route, uint32_t board_position, uint32_t alight_position) const;
+    // Ожидание плюс время в пути
+    double ComputeRideTime(const Route& route, uint32_t board_position, uint32_t alight_position) const;
+
+    int bus_wait_time_;
+    double meters_per_minute_;
+    std::vector<Route> routes_;
+    // Позиции автобусов на остановке s: [stop_route_offsets_[s], stop_route_offsets_[s + 1])
+    // в stop_routes_ — пары (маршрут, позиция)
+    std::vector<size_t> stop_route_offsets_;
+    std::vector<std::pair<uint32_t, uint32_t>> stop_routes_;
+
+    mutable size_t query_count_ = 0;
+    mutable size_t round_count_ = 0;
+    mutable size_t scanned_stop_count_ = 0;
+};
+
+}  // namespace router
@@ -7,7 +7,7 @@ namespace handler{
     RequestHandler::RequestHandler(catalogue::TransportCatalogue& catalogue) 
         : catalogue_(catalogue) {}
 
-    void RequestHandler::AddStop(const std::string& name, double lat, double lng) {
+    void RequestHandler::AddStop(std::string_view name, double lat, double lng) {
         catalogue_.AddStop({name, {lat, lng}});
     }
 
@@ -15,19 +15,35 @@ namespace handler{
         catalogue_.AddDistance(stop1, stop2, distance);
     }
 
-    void RequestHandler::AddBus(const std::string& name, const std::vector<std::string>& stops, bool is_roundtrip) {
+    void RequestHandler::AddBus(std::string_view name, const std::vector<std::string_view>& stops, bool is_roundtrip) {
         catalogue_.AddBus(name, stops, is_roundtrip);
     }
 
+    bool RequestHandler::RemoveBus(const std::string& name) {
+        return catalogue_.RemoveBus(name);
+    }
+
+    void RequestHandler::AddObserver(catalogue::CatalogueObserver* observer) {
+        catalogue_.AddObserver(observer);
+    }
+
+    void RequestHandler::RemoveObserver(catalogue::CatalogueObserver* observer) {
+        catalogue_.RemoveObserver(observer);
+    }
+
+    void RequestHandler::Freeze() {
+        catalogue_.Freeze();
+    }
+
+    void RequestHandler::LoadSnapshot(const std::string& path) {
+        catalogue_.LoadSnapshot(path);
+    }
+
     std::optional<domain::BusStat> RequestHandler::GetBusStat(const std::string_view& bus_name) const {
         return catalogue_.GetBusInfo(bus_name);
     }
 
-    const std::set<std::string_view> RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
-        if(catalogue_.FindStop(stop_name) == nullptr) {
-            return {};
-        }
-        
+    ranges::Span<domain::BusId> RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
         return catalogue_.GetStopInfo(stop_name);
     }
     
@@ -38,11 +54,11 @@ namespace handler{
         return true;
     }
     
-    std::set<domain::Stop*> RequestHandler::GetAllStops() const {
+    std::set<const domain::Stop*> RequestHandler::GetAllStops() const {
         return  catalogue_.GetStopsInRoutes();
     }
 
-    const std::map<std::string_view, domain::Bus*>& RequestHandler::GetAllBuses() const {
+    const std::vector<std::pair<std::string_view, const domain::Bus*>>& RequestHandler::GetAllBuses() const {
         return catalogue_.GetAllBuses();
     }
     
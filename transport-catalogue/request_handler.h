@@ -24,21 +24,34 @@ class RequestHandler {
 public:
     RequestHandler(catalogue::TransportCatalogue& catalogue);
 
-    void AddStop(const std::string& name, double lat, double lng);
+    void AddStop(std::string_view name, double lat, double lng);
 
     void AddDistance(const std::string& stop1, const std::string& stop2, int distance);
 
-    void AddBus(const std::string& name, const std::vector<std::string>& stops, bool is_roundtrip);
+    void AddBus(std::string_view name, const std::vector<std::string_view>& stops, bool is_roundtrip);
+
+    bool RemoveBus(const std::string& name);
+
+    void AddObserver(catalogue::CatalogueObserver* observer);
+
+    void RemoveObserver(catalogue::CatalogueObserver* observer);
+
+    // Каталог становится неизменяемым снимком, см. TransportCatalogue::Freeze
+    void Freeze();
+
+    // Каталог из файла снимка, см. TransportCatalogue::LoadSnapshot
+    void LoadSnapshot(const std::string& path);
 
     std::optional<domain::BusStat> GetBusStat(const std::string_view& bus_name) const;
 
-    const std::set<std::string_view> GetBusesByStop(const std::string_view& stop_name) const;
+    // id автобусов по возрастанию имени
+    ranges::Span<domain::BusId> GetBusesByStop(const std::string_view& stop_name) const;
     
     bool CheckStop(const std::string_view& stop_name);
     
-    std::set<domain::Stop*> GetAllStops() const;
+    std::set<const domain::Stop*> GetAllStops() const;
 
-    const std::map<std::string_view, domain::Bus*>& GetAllBuses() const;
+    const std::vector<std::pair<std::string_view, const domain::Bus*>>& GetAllBuses() const;
     
     const catalogue::TransportCatalogue& GetCatalogue() const;
     
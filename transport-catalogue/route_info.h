@@ -0,0 +1,39 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace router {
+
+// Поездка на автобусе bus_name от остановки from до остановки to (индексы в каталоге):
+// time — ожидание плюс время в пути, span_count — число перегонов
+struct RideInfo {
+    size_t from = 0;
+    size_t to = 0;
+    double time = 0.0;
+    std::string_view bus_name;
+    int span_count = 0;
+};
+
+struct RouteInfo {
+    double full_time = 0.0;
+    std::vector<RideInfo> rides;
+};
+
+// Пеший участок: distance метров по прямой за time минут
+struct WalkInfo {
+    double distance = 0.0;
+    double time = 0.0;
+};
+
+// Маршрут между произвольными точками: пешком до первой остановки, поездки, пешком от последней.
+// Участка нет, если конец маршрута совпадает с остановкой; путь целиком пешком — один walk_to_stop без поездок
+struct PointRouteInfo {
+    double full_time = 0.0;
+    std::optional<WalkInfo> walk_to_stop;
+    std::vector<RideInfo> rides;
+    std::optional<WalkInfo> walk_from_stop;
+};
+
+}  // namespace router
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "graph.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+// Описывает, как вес хранится в ячейке таблицы маршрутов.
+// Недостижимость кодируется значением INFINITE вместо std::optional.
+template <typename StoredWeight>
+struct StoredWeightTraits;
+
+template <>
+struct StoredWeightTraits<double> {
+    static constexpr double INFINITE = std::numeric_limits<double>::infinity();
+
+    template <typename Weight>
+    static double Encode(Weight weight) {
+        return static_cast<double>(weight);
+    }
+    static double Add(double lhs, double rhs) {
+        return lhs + rhs;
+    }
+};
+
+template <>
+struct StoredWeightTraits<float> {
+    static constexpr float INFINITE = std::numeric_limits<float>::infinity();
+
+    template <typename Weight>
+    static float Encode(Weight weight) {
+        return static_cast<float>(weight);
+    }
+    static float Add(float lhs, float rhs) {
+        return lhs + rhs;
+    }
+};
+
+// Фиксированная точка: тысячные доли единицы веса (для маршрутов — минуты × 1000)
+template <>
+struct StoredWeightTraits<uint32_t> {
+    static constexpr uint32_t INFINITE = std::numeric_limits<uint32_t>::max();
+    static constexpr double SCALE = 1000.0;
+
+    template <typename Weight>
+    static uint32_t Encode(Weight weight) {
+        const double scaled = std::round(static_cast<double>(weight) * SCALE);
+        if (scaled >= static_cast<double>(INFINITE)) {
+            throw std::overflow_error("Weight does not fit into fixed-point route table");
+        }
+        return static_cast<uint32_t>(scaled);
+    }
+    static uint32_t Add(uint32_t lhs, uint32_t rhs) {
+        const uint64_t sum = static_cast<uint64_t>(lhs) + rhs;
+        return sum >= INFINITE ? INFINITE : static_cast<uint32_t>(sum);
+    }
+};
+
+// Плоская таблица V×V, хранимая построчно: веса и последние рёбра маршрутов лежат
+// в двух отдельных непрерывных массивах, ребро кодируется 32-битным индексом.
+// Таблица либо владеет массивами, либо является представлением поверх внешней памяти
+// (например, отображённого в память файла): такую таблицу можно только читать.
+template <typename StoredWeight>
+class RouteTable {
+public:
+    using Traits = StoredWeightTraits<StoredWeight>;
+    using CompactEdgeId = uint32_t;
+
+    static constexpr CompactEdgeId NO_EDGE = std::numeric_limits<CompactEdgeId>::max();
+
+    RouteTable() = default;
+
+    explicit RouteTable(size_t vertex_count)
+        : vertex_count_(vertex_count)
+        , weights_(vertex_count * vertex_count, Traits::INFINITE)
+        , prev_edges_(vertex_count * vertex_count, NO_EDGE) {
+    }
+
+    // Внешние массивы должны жить дольше таблицы
+    static RouteTable FromView(size_t vertex_count, const StoredWeight* weights, const CompactEdgeId* prev_edges) {
+        RouteTable table;
+        table.vertex_count_ = vertex_count;
+        table.weights_view_ = weights;
+        table.prev_edges_view_ = prev_edges;
+        return table;
+    }
+
+    bool IsView() const {
+        return weights_view_ != nullptr;
+    }
+
+    size_t GetVertexCount() const {
+        return vertex_count_;
+    }
+
+    StoredWeight* GetWeights(VertexId from) {
+        assert(!IsView());
+        return weights_.data() + from * vertex_count_;
+    }
+    const StoredWeight* GetWeights(VertexId from) const {
+        return (IsView() ? weights_view_ : weights_.data()) + from * vertex_count_;
+    }
+
+    CompactEdgeId* GetPrevEdges(VertexId from) {
+        assert(!IsView());
+        return prev_edges_.data() + from * vertex_count_;
+    }
+    const CompactEdgeId* GetPrevEdges(VertexId from) const {
+        return (IsView() ? prev_edges_view_ : prev_edges_.data()) + from * vertex_count_;
+    }
+
+    static CompactEdgeId ToCompactEdgeId(EdgeId edge_id) {
+        if (edge_id >= NO_EDGE) {
+            throw std::overflow_error("Edge id does not fit into 32 bits");
+        }
+        return static_cast<CompactEdgeId>(edge_id);
+    }
+
+    size_t GetMemoryUsage() const {
+        return weights_.capacity() * sizeof(StoredWeight)
+             + prev_edges_.capacity() * sizeof(CompactEdgeId);
+    }
+
+private:
+    size_t vertex_count_ = 0;
+    std::vector<StoredWeight> weights_;
+    std::vector<CompactEdgeId> prev_edges_;
+    const StoredWeight* weights_view_ = nullptr;
+    const CompactEdgeId* prev_edges_view_ = nullptr;
+};
+
+}  // namespace graph
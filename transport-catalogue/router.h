@@ -1,117 +1,517 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus.h"
+#include "parallel.h"
+#include "route_table.h"
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <functional>
+#include <iostream>
 #include <iterator>
+#include <limits>
 #include <optional>
+#include <queue>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace graph {
 
+// Изменение графа между двумя заморозками
 template <typename Weight>
-class Router {
-private:
-    using Graph = DirectedWeightedGraph<Weight>;
+struct GraphUpdate {
+    // Результат Freeze: новые id рёбер по старым, NO_EDGE_ID для удалённых
+    std::vector<EdgeId> new_edge_ids;
+    // Новые вершины получают id, начиная с old_vertex_count
+    size_t old_vertex_count = 0;
+    // Новые id добавленных рёбер
+    std::vector<EdgeId> added_edges;
+};
 
+// Общий интерфейс движков поиска кратчайших путей по графу
+template <typename Weight>
+class RoutingEngine {
 public:
-    explicit Router(const Graph& graph);
-
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+    // Маршруты из from в каждую вершину targets в том же порядке. По умолчанию — отдельный
+    // запрос на каждую цель; движки без предрасчёта строят одно дерево кратчайших путей.
+    virtual std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(targets.size());
+        for (const VertexId to : targets) {
+            routes.push_back(BuildRoute(from, to));
+        }
+        return routes;
+    }
+
+    // Веса кратчайших путей для всех пар sources × targets построчно: вес пары (i, j)
+    // лежит в ячейке i * targets.size() + j, для недостижимых пар — nullopt
+    virtual std::vector<std::optional<Weight>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                                 const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(sources.size() * targets.size());
+        for (const VertexId from : sources) {
+            for (const auto& route : BuildRoutes(from, targets)) {
+                weights.push_back(route ? std::optional<Weight>{route->weight} : std::nullopt);
+            }
+        }
+        return weights;
+    }
+
+    // Объём памяти, занятой служебными структурами движка, в байтах
+    virtual size_t GetMemoryUsage() const = 0;
+
+    // Выводит диагностику движка: время предрасчёта, размеры кэшей и т.п.
+    virtual void PrintStats(std::ostream&) const {
+    }
 
+    // Приводит служебные структуры в соответствие с изменённым графом. Возвращает false,
+    // если движок так не умеет и его нужно построить заново.
+    virtual bool ApplyUpdate(const GraphUpdate<Weight>&) {
+        return false;
+    }
+
+    virtual ~RoutingEngine() = default;
+};
+
+// Способ обхода таблицы при предрасчёте
+enum class RelaxKernel {
+    // Построчно для каждой промежуточной вершины
+    CLASSIC,
+    // По квадратным блокам BLOCK_SIZE × BLOCK_SIZE, помещающимся в кэш
+    BLOCKED,
+};
+
+// Предрасчёт кратчайших путей между всеми парами вершин (Флойд — Уоршелл).
+// StoredWeight задаёт тип веса в таблице: double, float или фиксированная точка uint32_t.
+// При thread_count > 1 работа каждого шага делится между потоками: строки таблицы для
+// CLASSIC или блоки одной фазы для BLOCKED. Шаги разделены барьером, поэтому результат
+// не зависит от числа потоков.
+template <typename Weight, typename StoredWeight = Weight>
+class Router final : public RoutingEngine<Weight> {
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+    using Table = RouteTable<StoredWeight>;
+    using Traits = typename Table::Traits;
+
+    using Duration = std::chrono::duration<double, std::milli>;
+
+    struct PrecomputeStats {
+        Duration wall_time{};
+        std::vector<Duration> thread_busy_times;
     };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    explicit Router(const Graph& graph, size_t thread_count = 1, RelaxKernel kernel = RelaxKernel::CLASSIC);
+
+    // Использует готовую таблицу, например загруженную из файла; предрасчёт не выполняется
+    Router(const Graph& graph, Table route_table);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Веса берутся прямо из строк таблицы, без восстановления путей
+    std::vector<std::optional<Weight>> BuildWeightMatrix(const std::vector<VertexId>& sources,
+                                                         const std::vector<VertexId>& targets) const override;
+
+    size_t GetMemoryUsage() const override;
+
+    void PrintStats(std::ostream& output) const override;
+
+    // Перенумеровывает рёбра в таблице, пересчитывает Дейкстрой строки, чьи пути шли
+    // через удалённые рёбра, и ослабляет все строки через каждое добавленное ребро.
+    // Если пересчёт строк дороже полного предрасчёта, возвращает false.
+    bool ApplyUpdate(const GraphUpdate<Weight>& update) override;
+
+    const PrecomputeStats& GetPrecomputeStats() const;
+
+    const Table& GetRouteTable() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
 
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+            StoredWeight* weights = routes_internal_data_.GetWeights(vertex);
+            auto* prev_edges = routes_internal_data_.GetPrevEdges(vertex);
+            weights[vertex] = Traits::Encode(ZERO_WEIGHT);
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                 const auto& edge = graph.GetEdge(edge_id);
                 if (edge.weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                const StoredWeight edge_weight = Traits::Encode(edge.weight);
+                if (edge_weight < weights[edge.to]) {
+                    weights[edge.to] = edge_weight;
+                    prev_edges[edge.to] = Table::ToCompactEdgeId(edge_id);
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    // Обрабатывает строки first_row, first_row + row_step, ...
+    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through,
+                                              size_t first_row = 0, size_t row_step = 1) {
+        const StoredWeight* weights_through = routes_internal_data_.GetWeights(vertex_through);
+        const auto* prev_edges_through = routes_internal_data_.GetPrevEdges(vertex_through);
+        for (VertexId vertex_from = first_row; vertex_from < vertex_count; vertex_from += row_step) {
+            StoredWeight* weights_from = routes_internal_data_.GetWeights(vertex_from);
+            const StoredWeight weight_from = weights_from[vertex_through];
+            if (vertex_from == vertex_through || weight_from == Traits::INFINITE) {
+                continue;
+            }
+            // Последнее ребро пути from → through → to совпадает с последним ребром
+            // пути through → to: путь through → through пуст только при to == through,
+            // а эта ячейка не улучшается
+            MinPlusRow(weight_from, weights_through, prev_edges_through,
+                       weights_from, routes_internal_data_.GetPrevEdges(vertex_from), vertex_count);
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    // Релаксация блока строк row_block и столбцов column_block через вершины блока through_block
+    void RelaxTile(size_t row_block, size_t column_block, size_t through_block) {
+        const size_t vertex_count = routes_internal_data_.GetVertexCount();
+        const size_t first_column = column_block * BLOCK_SIZE;
+        const size_t column_count = std::min(BLOCK_SIZE, vertex_count - first_column);
+        const size_t row_end = std::min((row_block + 1) * BLOCK_SIZE, vertex_count);
+        const size_t through_end = std::min((through_block + 1) * BLOCK_SIZE, vertex_count);
+
+        for (VertexId vertex_through = through_block * BLOCK_SIZE; vertex_through < through_end; ++vertex_through) {
+            const StoredWeight* weights_through = routes_internal_data_.GetWeights(vertex_through) + first_column;
+            const auto* prev_edges_through = routes_internal_data_.GetPrevEdges(vertex_through) + first_column;
+            for (VertexId vertex_from = row_block * BLOCK_SIZE; vertex_from < row_end; ++vertex_from) {
+                StoredWeight* weights_from = routes_internal_data_.GetWeights(vertex_from);
+                const StoredWeight weight_from = weights_from[vertex_through];
+                if (vertex_from == vertex_through || weight_from == Traits::INFINITE) {
+                    continue;
+                }
+                MinPlusRow(weight_from, weights_through, prev_edges_through, weights_from + first_column,
+                           routes_internal_data_.GetPrevEdges(vertex_from) + first_column, column_count);
+            }
+        }
+    }
+
+    void RelaxAllRoutes(size_t thread_count) {
+        const size_t vertex_count = graph_.GetVertexCount();
+        stats_.thread_busy_times.assign(thread_count, Duration{});
+        parallel::Barrier barrier(thread_count);
+
+        parallel::RunInThreads(thread_count, barrier, [&](size_t thread_index) {
+            Duration busy_time{};
+            for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+                const auto start = Clock::now();
+                RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through, thread_index, thread_count);
+                busy_time += Clock::now() - start;
+                barrier.ArriveAndWait();
+            }
+            stats_.thread_busy_times[thread_index] = busy_time;
+        });
+    }
+
+    // Блочный Флойд — Уоршелл: для каждого диагонального блока сначала он сам,
+    // затем блоки его строки и столбца, затем все остальные
+    void RelaxAllRoutesBlocked(size_t thread_count) {
+        const size_t vertex_count = graph_.GetVertexCount();
+        const size_t block_count = (vertex_count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        stats_.thread_busy_times.assign(thread_count, Duration{});
+        parallel::Barrier barrier(thread_count);
+
+        parallel::RunInThreads(thread_count, barrier, [&](size_t thread_index) {
+            Duration busy_time{};
+            for (size_t through_block = 0; through_block < block_count; ++through_block) {
+                auto start = Clock::now();
+                if (thread_index == 0) {
+                    RelaxTile(through_block, through_block, through_block);
+                }
+                busy_time += Clock::now() - start;
+                barrier.ArriveAndWait();
+
+                start = Clock::now();
+                for (size_t block = thread_index; block < block_count; block += thread_count) {
+                    if (block != through_block) {
+                        RelaxTile(through_block, block, through_block);
+                        RelaxTile(block, through_block, through_block);
                     }
                 }
+                busy_time += Clock::now() - start;
+                barrier.ArriveAndWait();
+
+                start = Clock::now();
+                for (size_t tile = thread_index; tile < block_count * block_count; tile += thread_count) {
+                    const size_t row_block = tile / block_count;
+                    const size_t column_block = tile % block_count;
+                    if (row_block != through_block && column_block != through_block) {
+                        RelaxTile(row_block, column_block, through_block);
+                    }
+                }
+                busy_time += Clock::now() - start;
+                barrier.ArriveAndWait();
             }
+            stats_.thread_busy_times[thread_index] = busy_time;
+        });
+    }
+
+    // Переносит таблицу в собственную память и расширяет её до числа вершин графа
+    void ResizeRoutesInternalData() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        const Table& old_table = routes_internal_data_;
+        const size_t old_vertex_count = old_table.GetVertexCount();
+        Table table(vertex_count);
+        for (VertexId vertex = 0; vertex < old_vertex_count; ++vertex) {
+            std::copy_n(old_table.GetWeights(vertex), old_vertex_count, table.GetWeights(vertex));
+            std::copy_n(old_table.GetPrevEdges(vertex), old_vertex_count, table.GetPrevEdges(vertex));
+        }
+        for (VertexId vertex = old_vertex_count; vertex < vertex_count; ++vertex) {
+            table.GetWeights(vertex)[vertex] = Traits::Encode(ZERO_WEIGHT);
+        }
+        routes_internal_data_ = std::move(table);
+    }
+
+    // Строка from заново считается Дейкстрой по текущему графу
+    void RecomputeRow(VertexId from) {
+        const size_t vertex_count = graph_.GetVertexCount();
+        std::vector<Weight> weights(vertex_count, std::numeric_limits<Weight>::max());
+        std::vector<EdgeId> prev_edges(vertex_count, NO_EDGE_ID);
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        weights[from] = ZERO_WEIGHT;
+        queue.push({ZERO_WEIGHT, from});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > weights[vertex]) {
+                continue;
+            }
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                if (weight + edge.weight < weights[edge.to]) {
+                    weights[edge.to] = weight + edge.weight;
+                    prev_edges[edge.to] = edge_id;
+                    queue.push({weights[edge.to], edge.to});
+                }
+            }
+        }
+
+        StoredWeight* row_weights = routes_internal_data_.GetWeights(from);
+        auto* row_prev_edges = routes_internal_data_.GetPrevEdges(from);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            const bool reached = weights[vertex] != std::numeric_limits<Weight>::max();
+            row_weights[vertex] = reached ? Traits::Encode(weights[vertex]) : Traits::INFINITE;
+            row_prev_edges[vertex] = prev_edges[vertex] == NO_EDGE_ID
+                                   ? Table::NO_EDGE : Table::ToCompactEdgeId(prev_edges[vertex]);
+        }
+    }
+
+    // Пути, улучшенные добавленным ребром u → v, имеют вид from → u → v → to
+    void RelaxThroughAddedEdge(EdgeId edge_id) {
+        const size_t vertex_count = graph_.GetVertexCount();
+        const auto& edge = graph_.GetEdge(edge_id);
+        const StoredWeight edge_weight = Traits::Encode(edge.weight);
+        // Строка v не меняется: путь v → u → v → to не короче v → to
+        const StoredWeight* weights_through = routes_internal_data_.GetWeights(edge.to);
+        const auto* prev_edges_through = routes_internal_data_.GetPrevEdges(edge.to);
+        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+            StoredWeight* weights_from = routes_internal_data_.GetWeights(vertex_from);
+            auto* prev_edges_from = routes_internal_data_.GetPrevEdges(vertex_from);
+            if (weights_from[edge.from] == Traits::INFINITE) {
+                continue;
+            }
+            const StoredWeight weight_through = Traits::Add(weights_from[edge.from], edge_weight);
+            // Если путь до v не улучшился, то и пути через v не улучшатся
+            if (!(weight_through < weights_from[edge.to])) {
+                continue;
+            }
+            weights_from[edge.to] = weight_through;
+            prev_edges_from[edge.to] = Table::ToCompactEdgeId(edge_id);
+            MinPlusRow(weight_through, weights_through, prev_edges_through,
+                       weights_from, prev_edges_from, vertex_count);
         }
     }
 
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    Table routes_internal_data_;
+    PrecomputeStats stats_;
+    size_t update_count_ = 0;
+    size_t recomputed_row_count_ = 0;
 };
 
-template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+template <typename Weight, typename StoredWeight>
+Router<Weight, StoredWeight>::Router(const Graph& graph, size_t thread_count, RelaxKernel kernel)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , routes_internal_data_(graph.GetVertexCount())
 {
+    const auto start = Clock::now();
     InitializeRoutesInternalData(graph);
+    // Потоки делят строки таблицы или её блоки, лишним потокам работы нет
+    if (kernel == RelaxKernel::BLOCKED) {
+        const size_t block_count = (graph.GetVertexCount() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        RelaxAllRoutesBlocked(std::clamp<size_t>(thread_count, 1, std::max<size_t>(block_count, 1)));
+    } else {
+        RelaxAllRoutes(std::clamp<size_t>(thread_count, 1, std::max<size_t>(graph.GetVertexCount(), 1)));
+    }
+    stats_.wall_time = Clock::now() - start;
+}
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+template <typename Weight, typename StoredWeight>
+Router<Weight, StoredWeight>::Router(const Graph& graph, Table route_table)
+    : graph_(graph)
+    , routes_internal_data_(std::move(route_table))
+{
+    if (routes_internal_data_.GetVertexCount() != graph.GetVertexCount()) {
+        throw std::invalid_argument("Route table does not match the graph");
     }
 }
 
-template <typename Weight>
-std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-                                                                             VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+template <typename Weight, typename StoredWeight>
+std::vector<std::optional<Weight>> Router<Weight, StoredWeight>::BuildWeightMatrix(
+    const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+    // Сжатые веса неточны, поэтому для них веса считаются по рёбрам восстановленных путей
+    if constexpr (!std::is_same_v<Weight, StoredWeight>) {
+        return RoutingEngine<Weight>::BuildWeightMatrix(sources, targets);
+    } else {
+        const size_t vertex_count = routes_internal_data_.GetVertexCount();
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(sources.size() * targets.size());
+        for (const VertexId from : sources) {
+            if (from >= vertex_count) {
+                throw std::out_of_range("Vertex is out of range");
+            }
+            const StoredWeight* row = routes_internal_data_.GetWeights(from);
+            for (const VertexId to : targets) {
+                if (to >= vertex_count) {
+                    throw std::out_of_range("Vertex is out of range");
+                }
+                weights.push_back(row[to] == Traits::INFINITE ? std::nullopt : std::optional<Weight>{row[to]});
+            }
+        }
+        return weights;
+    }
+}
+
+template <typename Weight, typename StoredWeight>
+std::optional<typename Router<Weight, StoredWeight>::RouteInfo> Router<Weight, StoredWeight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    if (from >= routes_internal_data_.GetVertexCount() || to >= routes_internal_data_.GetVertexCount()) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+    const StoredWeight* weights = routes_internal_data_.GetWeights(from);
+    const auto* prev_edges = routes_internal_data_.GetPrevEdges(from);
+    if (weights[to] == Traits::INFINITE) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+    for (auto edge_id = prev_edges[to];
+         edge_id != Table::NO_EDGE;
+         edge_id = prev_edges[graph_.GetEdge(edge_id).from])
     {
-        edges.push_back(*edge_id);
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
 
+    // Для сжатых типов хранения вес пересчитывается по рёбрам без потери точности
+    Weight weight = ZERO_WEIGHT;
+    if constexpr (std::is_same_v<Weight, StoredWeight>) {
+        weight = weights[to];
+    } else {
+        for (const EdgeId edge_id : edges) {
+            weight += graph_.GetEdge(edge_id).weight;
+        }
+    }
     return RouteInfo{weight, std::move(edges)};
 }
 
-}  // namespace graph
\ No newline at end of file
+template <typename Weight, typename StoredWeight>
+size_t Router<Weight, StoredWeight>::GetMemoryUsage() const {
+    return routes_internal_data_.GetMemoryUsage();
+}
+
+template <typename Weight, typename StoredWeight>
+void Router<Weight, StoredWeight>::PrintStats(std::ostream& output) const {
+    output << "all_pairs: threads=" << stats_.thread_busy_times.size()
+           << " wall_ms=" << stats_.wall_time.count() << " thread_busy_ms=[";
+    bool first = true;
+    for (const Duration& busy_time : stats_.thread_busy_times) {
+        output << (first ? "" : ", ") << busy_time.count();
+        first = false;
+    }
+    output << "] updates=" << update_count_ << " recomputed_rows=" << recomputed_row_count_ << std::endl;
+}
+
+template <typename Weight, typename StoredWeight>
+bool Router<Weight, StoredWeight>::ApplyUpdate(const GraphUpdate<Weight>& update) {
+    const size_t old_vertex_count = routes_internal_data_.GetVertexCount();
+    const auto is_removed = [&](typename Table::CompactEdgeId edge_id) {
+        return edge_id != Table::NO_EDGE && update.new_edge_ids[edge_id] == NO_EDGE_ID;
+    };
+    std::vector<VertexId> broken_rows;
+    for (VertexId vertex_from = 0; vertex_from < old_vertex_count; ++vertex_from) {
+        const auto* prev_edges = std::as_const(routes_internal_data_).GetPrevEdges(vertex_from);
+        if (std::any_of(prev_edges, prev_edges + old_vertex_count, is_removed)) {
+            broken_rows.push_back(vertex_from);
+        }
+    }
+
+    // Дейкстра для строки стоит порядка E·log V, полный предрасчёт — порядка V³
+    const double vertex_count = static_cast<double>(graph_.GetVertexCount());
+    const double recompute_cost = static_cast<double>(broken_rows.size()) * static_cast<double>(graph_.GetEdgeCount())
+                                * std::log2(vertex_count + 1);
+    if (recompute_cost > vertex_count * vertex_count * vertex_count) {
+        return false;
+    }
+
+    if (routes_internal_data_.IsView() || old_vertex_count != graph_.GetVertexCount()) {
+        ResizeRoutesInternalData();
+    }
+    for (VertexId vertex_from = 0; vertex_from < old_vertex_count; ++vertex_from) {
+        auto* prev_edges = routes_internal_data_.GetPrevEdges(vertex_from);
+        for (VertexId vertex_to = 0; vertex_to < old_vertex_count; ++vertex_to) {
+            if (prev_edges[vertex_to] != Table::NO_EDGE) {
+                const EdgeId new_edge_id = update.new_edge_ids[prev_edges[vertex_to]];
+                prev_edges[vertex_to] = new_edge_id == NO_EDGE_ID ? Table::NO_EDGE : Table::ToCompactEdgeId(new_edge_id);
+            }
+        }
+    }
+
+    // Пересчитанные строки уже учитывают добавленные рёбра, а последующее ослабление
+    // их не меняет: точное расстояние улучшить нельзя
+    for (const VertexId vertex_from : broken_rows) {
+        RecomputeRow(vertex_from);
+    }
+    for (const EdgeId edge_id : update.added_edges) {
+        RelaxThroughAddedEdge(edge_id);
+    }
+    ++update_count_;
+    recomputed_row_count_ += broken_rows.size();
+    return true;
+}
+
+template <typename Weight, typename StoredWeight>
+const typename Router<Weight, StoredWeight>::PrecomputeStats&
+Router<Weight, StoredWeight>::GetPrecomputeStats() const {
+    return stats_;
+}
+
+template <typename Weight, typename StoredWeight>
+const typename Router<Weight, StoredWeight>::Table& Router<Weight, StoredWeight>::GetRouteTable() const {
+    return routes_internal_data_;
+}
+
+}  // namespace graph
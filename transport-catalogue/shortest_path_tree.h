@@ -0,0 +1,220 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Дерево кратчайших путей из одного источника: вес пути и последнее ребро пути до каждой вершины
+template <typename Weight>
+struct ShortestPathTree {
+    static constexpr Weight UNREACHED_WEIGHT = std::numeric_limits<Weight>::max();
+
+    std::vector<Weight> weights;
+    std::vector<EdgeId> prev_edges;
+};
+
+// Обёртка над std::priority_queue с интерфейсом RadixHeap
+template <typename Weight>
+class BinaryQueue {
+public:
+    void Push(Weight weight, VertexId vertex) {
+        queue_.push({weight, vertex});
+    }
+    std::pair<Weight, VertexId> Pop() {
+        auto top = queue_.top();
+        queue_.pop();
+        return top;
+    }
+    bool Empty() const {
+        return queue_.empty();
+    }
+
+private:
+    using Item = std::pair<Weight, VertexId>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue_;
+};
+
+// Полный проход Дейкстры из from по замороженному графу
+template <typename Weight, typename Queue = BinaryQueue<Weight>>
+ShortestPathTree<Weight> BuildShortestPathTree(const DirectedWeightedGraph<Weight>& graph, VertexId from) {
+    constexpr Weight zero_weight{};
+    const size_t vertex_count = graph.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+    ShortestPathTree<Weight> tree{std::vector<Weight>(vertex_count, ShortestPathTree<Weight>::UNREACHED_WEIGHT),
+                                  std::vector<EdgeId>(vertex_count, NO_EDGE_ID)};
+    Queue queue;
+    tree.weights[from] = zero_weight;
+    queue.Push(zero_weight, from);
+
+    while (!queue.Empty()) {
+        const auto [weight, vertex] = queue.Pop();
+        if (weight > tree.weights[vertex]) {
+            continue;
+        }
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.weight < zero_weight) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            const Weight candidate_weight = weight + edge.weight;
+            if (candidate_weight < tree.weights[edge.to]) {
+                tree.weights[edge.to] = candidate_weight;
+                tree.prev_edges[edge.to] = edge_id;
+                queue.Push(candidate_weight, edge.to);
+            }
+        }
+    }
+    return tree;
+}
+
+// Вершины, достижимые из from путём веса не больше max_weight, в порядке неубывания веса.
+// Вершины дальше max_weight в очередь не попадают, так что поиск не выходит за границу бюджета.
+template <typename Weight, typename Queue = BinaryQueue<Weight>>
+std::vector<std::pair<VertexId, Weight>> FindReachableVertices(const DirectedWeightedGraph<Weight>& graph,
+                                                               VertexId from, Weight max_weight) {
+    constexpr Weight zero_weight{};
+    const size_t vertex_count = graph.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+    std::vector<std::pair<VertexId, Weight>> reachable;
+    if (max_weight < zero_weight) {
+        return reachable;
+    }
+    std::vector<Weight> weights(vertex_count, ShortestPathTree<Weight>::UNREACHED_WEIGHT);
+    Queue queue;
+    weights[from] = zero_weight;
+    queue.Push(zero_weight, from);
+
+    while (!queue.Empty()) {
+        const auto [weight, vertex] = queue.Pop();
+        if (weight > weights[vertex]) {
+            continue;
+        }
+        reachable.emplace_back(vertex, weight);
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+            if (candidate_weight <= max_weight && candidate_weight < weights[edge.to]) {
+                weights[edge.to] = candidate_weight;
+                queue.Push(candidate_weight, edge.to);
+            }
+        }
+    }
+    return reachable;
+}
+
+// Лучший путь из нескольких источников в несколько целей: weight — вес самого пути,
+// source и target — его концы
+template <typename Weight>
+struct MultiPointRoute {
+    Weight weight;
+    VertexId source;
+    VertexId target;
+    std::vector<EdgeId> edges;
+};
+
+// Один проход Дейкстры сразу из всех sources: источник стартует со своим начальным весом,
+// а к весу пути до цели прибавляется её конечный вес. Выбирается путь с наименьшей суммой;
+// поиск останавливается, как только очередная вершина не легче лучшей найденной суммы
+template <typename Weight, typename Queue = BinaryQueue<Weight>>
+std::optional<MultiPointRoute<Weight>> FindBestMultiPointRoute(const DirectedWeightedGraph<Weight>& graph,
+                                                               const std::vector<std::pair<VertexId, Weight>>& sources,
+                                                               const std::vector<std::pair<VertexId, Weight>>& targets) {
+    constexpr Weight UNREACHED_WEIGHT = ShortestPathTree<Weight>::UNREACHED_WEIGHT;
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<Weight> final_weights(vertex_count, UNREACHED_WEIGHT);
+    for (const auto& [vertex, weight] : targets) {
+        final_weights.at(vertex) = std::min(final_weights[vertex], weight);
+    }
+    ShortestPathTree<Weight> tree{std::vector<Weight>(vertex_count, UNREACHED_WEIGHT),
+                                  std::vector<EdgeId>(vertex_count, NO_EDGE_ID)};
+    Queue queue;
+    for (const auto& [vertex, weight] : sources) {
+        if (weight < tree.weights.at(vertex)) {
+            tree.weights[vertex] = weight;
+            queue.Push(weight, vertex);
+        }
+    }
+
+    Weight best_total = UNREACHED_WEIGHT;
+    VertexId best_target = 0;
+    while (!queue.Empty()) {
+        const auto [weight, vertex] = queue.Pop();
+        if (!(weight < best_total)) {
+            break;
+        }
+        if (weight > tree.weights[vertex]) {
+            continue;
+        }
+        if (final_weights[vertex] != UNREACHED_WEIGHT && weight + final_weights[vertex] < best_total) {
+            best_total = weight + final_weights[vertex];
+            best_target = vertex;
+        }
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+            if (candidate_weight < tree.weights[edge.to]) {
+                tree.weights[edge.to] = candidate_weight;
+                tree.prev_edges[edge.to] = edge_id;
+                queue.Push(candidate_weight, edge.to);
+            }
+        }
+    }
+    if (best_total == UNREACHED_WEIGHT) {
+        return std::nullopt;
+    }
+
+    MultiPointRoute<Weight> route{Weight{}, best_target, best_target, {}};
+    for (EdgeId edge_id = tree.prev_edges[best_target]; edge_id != NO_EDGE_ID;
+         edge_id = tree.prev_edges[route.source]) {
+        const auto& edge = graph.GetEdge(edge_id);
+        route.edges.push_back(edge_id);
+        route.weight += edge.weight;
+        route.source = edge.from;
+    }
+    std::reverse(route.edges.begin(), route.edges.end());
+    return route;
+}
+
+// Дописывает в weights веса путей до вершин targets по дереву; nullopt для недостижимых
+template <typename Weight>
+void AppendTreeWeights(const ShortestPathTree<Weight>& tree, const std::vector<VertexId>& targets,
+                       std::vector<std::optional<Weight>>& weights) {
+    for (const VertexId to : targets) {
+        const Weight weight = tree.weights.at(to);
+        weights.push_back(weight == ShortestPathTree<Weight>::UNREACHED_WEIGHT ? std::nullopt : std::optional<Weight>{weight});
+    }
+}
+
+// Путь до вершины to по дереву или nullopt, если она недостижима
+template <typename Weight>
+std::optional<typename RoutingEngine<Weight>::RouteInfo> ExtractRoute(
+    const DirectedWeightedGraph<Weight>& graph, const ShortestPathTree<Weight>& tree, VertexId to) {
+    if (tree.weights.at(to) == ShortestPathTree<Weight>::UNREACHED_WEIGHT) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = tree.prev_edges[to]; edge_id != NO_EDGE_ID;
+         edge_id = tree.prev_edges[graph.GetEdge(edge_id).from])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return typename RoutingEngine<Weight>::RouteInfo{tree.weights[to], std::move(edges)};
+}
+
+}  // namespace graph
@@ -0,0 +1,215 @@
+#define _USE_MATH_DEFINES
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace spatial {
+
+    namespace {
+
+        constexpr double EARTH_RADIUS = 6371000;
+        constexpr double DEGREE = M_PI / 180.0;
+        // geo::ComputeDistance считает через арккосинус, и на малых расстояниях его погрешность
+        // доходит до долей метра; на столько ослабляется отсечение, чтобы не потерять равные точки
+        constexpr double PRUNE_SLACK = 1.0;
+
+        double GetCoordinate(const geo::Coordinates& coord, uint8_t axis) {
+            return axis == 0 ? coord.lat : coord.lng;
+        }
+
+        double& GetCoordinate(geo::Coordinates& coord, uint8_t axis) {
+            return axis == 0 ? coord.lat : coord.lng;
+        }
+
+        // Разность долгот по кратчайшей дуге, в градусах от 0 до 180
+        double ComputeLongitudeGap(double lhs, double rhs) {
+            const double gap = std::abs(lhs - rhs);
+            return std::min(gap, 360.0 - gap);
+        }
+
+        // У совпадающих точек арккосинус может получить аргумент чуть больше единицы
+        double ComputeStopDistance(geo::Coordinates from, geo::Coordinates to) {
+            const double distance = geo::ComputeDistance(from, to);
+            return std::isnan(distance) ? 0.0 : distance;
+        }
+
+        bool IsCloser(const NearbyStop& lhs, const NearbyStop& rhs) {
+            return std::tie(lhs.distance, lhs.id) < std::tie(rhs.distance, rhs.id);
+        }
+
+    }  // namespace
+
+    struct SpatialIndex::Candidates {
+        size_t count;
+        double max_distance;
+        std::vector<NearbyStop> heap;
+
+        void Offer(domain::StopId id, double distance) {
+            const NearbyStop stop{id, distance};
+            if (distance > max_distance || (heap.size() == count && !IsCloser(stop, heap.front()))) {
+                return;
+            }
+            if (heap.size() == count) {
+                std::pop_heap(heap.begin(), heap.end(), IsCloser);
+                heap.pop_back();
+            }
+            heap.push_back(stop);
+            std::push_heap(heap.begin(), heap.end(), IsCloser);
+        }
+
+        // Дальше этого расстояния остановки уже не нужны
+        double GetBound() const {
+            return heap.size() == count ? heap.front().distance : max_distance;
+        }
+    };
+
+    SpatialIndex::SpatialIndex(const catalogue::TransportCatalogue& catalogue) {
+        const size_t stop_count = catalogue.GetStopCount();
+        points_.reserve(stop_count);
+        for (domain::StopId id = 0; id < stop_count; ++id) {
+            points_.push_back({catalogue.GetStop(id).coord, id});
+        }
+        axes_.resize(stop_count, LAT);
+        if (!points_.empty()) {
+            bounds_ = {points_.front().coord, points_.front().coord};
+            for (const Point& point : points_) {
+                bounds_.min = {std::min(bounds_.min.lat, point.coord.lat), std::min(bounds_.min.lng, point.coord.lng)};
+                bounds_.max = {std::max(bounds_.max.lat, point.coord.lat), std::max(bounds_.max.lng, point.coord.lng)};
+            }
+        }
+        Build(0, points_.size());
+    }
+
+    void SpatialIndex::Build(size_t begin, size_t end) {
+        if (end - begin <= LEAF_SIZE) {
+            return;
+        }
+        Box box{points_[begin].coord, points_[begin].coord};
+        for (size_t i = begin + 1; i < end; ++i) {
+            const geo::Coordinates coord = points_[i].coord;
+            box.min = {std::min(box.min.lat, coord.lat), std::min(box.min.lng, coord.lng)};
+            box.max = {std::max(box.max.lat, coord.lat), std::max(box.max.lng, coord.lng)};
+        }
+        // Градус долготы короче градуса широты в косинус широты раз
+        const double lat_extent = box.max.lat - box.min.lat;
+        const double lng_extent = (box.max.lng - box.min.lng) * std::cos((box.min.lat + box.max.lat) / 2 * DEGREE);
+        const Axis axis = lat_extent >= lng_extent ? LAT : LNG;
+
+        const size_t middle = begin + (end - begin) / 2;
+        std::nth_element(points_.begin() + begin, points_.begin() + middle, points_.begin() + end,
+                         [axis](const Point& lhs, const Point& rhs) {
+                             return GetCoordinate(lhs.coord, axis) < GetCoordinate(rhs.coord, axis);
+                         });
+        axes_[middle] = axis;
+        Build(begin, middle);
+        Build(middle + 1, end);
+    }
+
+    std::vector<NearbyStop> SpatialIndex::FindNearest(geo::Coordinates point, size_t count, double max_distance) const {
+        Candidates candidates{count, max_distance, {}};
+        if (count > 0 && max_distance >= 0.0) {
+            SearchNearest(0, points_.size(), bounds_, point, candidates);
+        }
+        std::sort_heap(candidates.heap.begin(), candidates.heap.end(), IsCloser);
+        return std::move(candidates.heap);
+    }
+
+    void SpatialIndex::SearchNearest(size_t begin, size_t end, const Box& box, geo::Coordinates point,
+                                     Candidates& candidates) const {
+        if (begin >= end) {
+            return;
+        }
+        // Нижняя оценка по формуле гаверсинусов: разность широт не меньше зазора по широте,
+        // разность долгот — зазора по долготе, косинус широты точки прямоугольника — меньшего
+        // из косинусов его границ
+        const double lat_gap = std::max({0.0, box.min.lat - point.lat, point.lat - box.max.lat}) * DEGREE;
+        const double lng_gap = (box.min.lng <= point.lng && point.lng <= box.max.lng)
+                             ? 0.0
+                             : std::min(ComputeLongitudeGap(point.lng, box.min.lng),
+                                        ComputeLongitudeGap(point.lng, box.max.lng)) * DEGREE;
+        const double min_cos = std::min(std::cos(box.min.lat * DEGREE), std::cos(box.max.lat * DEGREE));
+        const double haversine = std::pow(std::sin(lat_gap / 2), 2)
+                               + std::cos(point.lat * DEGREE) * min_cos * std::pow(std::sin(lng_gap / 2), 2);
+        const double lower_bound = 2 * EARTH_RADIUS * std::asin(std::sqrt(std::min(haversine, 1.0)));
+        if (lower_bound - PRUNE_SLACK > candidates.GetBound()) {
+            return;
+        }
+
+        if (end - begin <= LEAF_SIZE) {
+            for (size_t i = begin; i < end; ++i) {
+                candidates.Offer(points_[i].id, ComputeStopDistance(point, points_[i].coord));
+            }
+            return;
+        }
+        const size_t middle = begin + (end - begin) / 2;
+        const Axis axis = axes_[middle];
+        const double split = GetCoordinate(points_[middle].coord, axis);
+        candidates.Offer(points_[middle].id, ComputeStopDistance(point, points_[middle].coord));
+
+        Box left = box;
+        GetCoordinate(left.max, axis) = split;
+        Box right = box;
+        GetCoordinate(right.min, axis) = split;
+        // Сначала ближняя половина: найденные в ней остановки сильнее отсекают дальнюю
+        if (GetCoordinate(point, axis) < split) {
+            SearchNearest(begin, middle, left, point, candidates);
+            SearchNearest(middle + 1, end, right, point, candidates);
+        } else {
+            SearchNearest(middle + 1, end, right, point, candidates);
+            SearchNearest(begin, middle, left, point, candidates);
+        }
+    }
+
+    std::vector<domain::StopId> SpatialIndex::FindInBox(geo::Coordinates min, geo::Coordinates max) const {
+        std::vector<domain::StopId> stops;
+        if (min.lat <= max.lat && min.lng <= max.lng) {
+            SearchInBox(0, points_.size(), bounds_, {min, max}, stops);
+        }
+        std::sort(stops.begin(), stops.end());
+        return stops;
+    }
+
+    void SpatialIndex::SearchInBox(size_t begin, size_t end, const Box& box, const Box& query,
+                                   std::vector<domain::StopId>& stops) const {
+        if (begin >= end || box.max.lat < query.min.lat || query.max.lat < box.min.lat
+            || box.max.lng < query.min.lng || query.max.lng < box.min.lng) {
+            return;
+        }
+        const auto contains = [&query](geo::Coordinates coord) {
+            return query.min.lat <= coord.lat && coord.lat <= query.max.lat
+                && query.min.lng <= coord.lng && coord.lng <= query.max.lng;
+        };
+        if (end - begin <= LEAF_SIZE) {
+            for (size_t i = begin; i < end; ++i) {
+                if (contains(points_[i].coord)) {
+                    stops.push_back(points_[i].id);
+                }
+            }
+            return;
+        }
+        const size_t middle = begin + (end - begin) / 2;
+        const Axis axis = axes_[middle];
+        const double split = GetCoordinate(points_[middle].coord, axis);
+        if (contains(points_[middle].coord)) {
+            stops.push_back(points_[middle].id);
+        }
+
+        Box left = box;
+        GetCoordinate(left.max, axis) = split;
+        Box right = box;
+        GetCoordinate(right.min, axis) = split;
+        SearchInBox(begin, middle, left, query, stops);
+        SearchInBox(middle + 1, end, right, query, stops);
+    }
+
+    size_t SpatialIndex::GetStopCount() const {
+        return points_.size();
+    }
+
+    size_t SpatialIndex::GetMemoryUsage() const {
+        return points_.capacity() * sizeof(Point) + axes_.capacity() * sizeof(Axis);
+    }
+
+}  // namespace spatial
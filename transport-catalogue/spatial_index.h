@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "domain.h"
+#include "geo.h"
+#include "transport_catalogue.h"
+
+namespace spatial {
+
+struct NearbyStop {
+    domain::StopId id;
+    // Расстояние по geo::ComputeDistance, в метрах
+    double distance;
+};
+
+// Неявное k-d дерево по широте и долготе всех остановок каталога: точки переставлены так,
+// что узел диапазона [begin, end) лежит в его середине, левое поддерево — слева от неё.
+// Ось разбиения каждого узла — более протяжённая в метрах, диапазоны не длиннее LEAF_SIZE
+// просматриваются целиком. Поиск отсекает поддеревья по нижней оценке расстояния до их
+// прямоугольника широт и долгот, поэтому ответы совпадают с полным перебором.
+// Индекс — снимок: остановки, добавленные в каталог позже, в него не попадают.
+class SpatialIndex {
+public:
+    static constexpr double NO_LIMIT = std::numeric_limits<double>::infinity();
+
+    explicit SpatialIndex(const catalogue::TransportCatalogue& catalogue);
+
+    // Не больше count ближайших к point остановок не дальше max_distance метров,
+    // по возрастанию расстояния, при равенстве — по возрастанию id
+    std::vector<NearbyStop> FindNearest(geo::Coordinates point, size_t count, double max_distance = NO_LIMIT) const;
+
+    // Остановки с широтой в [min.lat, max.lat] и долготой в [min.lng, max.lng], по возрастанию id
+    std::vector<domain::StopId> FindInBox(geo::Coordinates min, geo::Coordinates max) const;
+
+    size_t GetStopCount() const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    static constexpr size_t LEAF_SIZE = 8;
+
+    enum Axis : uint8_t {
+        LAT,
+        LNG,
+    };
+
+    struct Point {
+        geo::Coordinates coord;
+        domain::StopId id;
+    };
+
+    struct Box {
+        geo::Coordinates min;
+        geo::Coordinates max;
+    };
+
+    // Ближайшие найденные остановки: ограниченная сверху по размеру max-куча
+    struct Candidates;
+
+    void Build(size_t begin, size_t end);
+    void SearchNearest(size_t begin, size_t end, const Box& box, geo::Coordinates point, Candidates& candidates) const;
+    void SearchInBox(size_t begin, size_t end, const Box& box, const Box& query, std::vector<domain::StopId>& stops) const;
+
+    std::vector<Point> points_;
+    // Ось разбиения узла по индексу его точки
+    std::vector<Axis> axes_;
+    Box bounds_{};
+};
+
+}  // namespace spatial
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace catalogue {
+
+// Хранилище строк в больших непрерывных блоках: одна аллокация на BLOCK_SIZE байт вместо одной на строку.
+// Выданные string_view валидны всё время жизни арены, строки не завершаются нулём.
+// Повторы арена не ищет — каталог сохраняет имя, только если его ещё нет в индексах.
+// Копирование запрещено: копия оставила бы string_view на блоки оригинала.
+class StringArena {
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    StringArena() = default;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+    StringArena(StringArena&&) = default;
+    StringArena& operator=(StringArena&&) = default;
+
+    std::string_view Store(std::string_view str) {
+        if (str.empty()) {
+            return {};
+        }
+        // Строка длиннее блока получает собственный блок, текущий остаётся последним
+        if (str.size() > BLOCK_SIZE) {
+            const auto it = blocks_.insert(blocks_.empty() ? blocks_.end() : blocks_.end() - 1,
+                                           Block{std::make_unique<char[]>(str.size()), str.size(), 0});
+            return Append(*it, str);
+        }
+        if (blocks_.empty() || blocks_.back().capacity - blocks_.back().size < str.size()) {
+            blocks_.push_back({std::make_unique<char[]>(BLOCK_SIZE), BLOCK_SIZE, 0});
+        }
+        return Append(blocks_.back(), str);
+    }
+
+    // Байты в блоках, включая незаполненные хвосты
+    size_t GetMemoryUsage() const {
+        size_t memory_usage = blocks_.capacity() * sizeof(Block);
+        for (const Block& block : blocks_) {
+            memory_usage += block.capacity;
+        }
+        return memory_usage;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t capacity = 0;
+        size_t size = 0;
+    };
+
+    static std::string_view Append(Block& block, std::string_view str) {
+        char* begin = block.data.get() + block.size;
+        std::memcpy(begin, str.data(), str.size());
+        block.size += str.size();
+        return {begin, str.size()};
+    }
+
+    std::vector<Block> blocks_;
+};
+
+}  // namespace catalogue
@@ -155,4 +155,8 @@ void Document::Render(std::ostream& out) const {
     out << "</svg>"sv;
 }
 
+void Document::Clear() {
+    objects_.clear();
+}
+
 }  // namespace svg
\ No newline at end of file
@@ -220,6 +220,9 @@ public:
 
     // Выводит в ostream svg-представление документа
     void Render(std::ostream& out) const;
+
+    // Удаляет все объекты документа
+    void Clear();
 };
 
 }  // namespace svg
\ No newline at end of file
@@ -0,0 +1,12 @@
+# Запускает BINARY на INPUT и сравнивает вывод с файлом EXPECTED
+execute_process(COMMAND ${BINARY}
+                INPUT_FILE ${INPUT}
+                OUTPUT_VARIABLE output
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${BINARY} exited with ${result}")
+endif()
+file(READ ${EXPECTED} expected)
+if(NOT output STREQUAL expected)
+    message(FATAL_ERROR "Output differs from ${EXPECTED}:\n${output}")
+endif()
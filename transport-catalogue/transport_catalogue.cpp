@@ -8,134 +8,335 @@ using namespace std;
 namespace catalogue {
 
 void TransportCatalogue::AddStop(const Stop& stop_new) {
-    stops_.push_back(move(stop_new));
-    stop_quest_[stops_.back().name] = &stops_.back();
-    stop_to_index_[stops_.back().name] = stop_to_index_.empty() ? 0 : stop_quest_.size() - 1;
+    CheckNotFrozen();
+    stops_.push_back(stop_new);
+    stops_.back().name = InternName(stop_new.name);
+    stops_.back().id = static_cast<StopId>(stops_.size() - 1);
+    stop_quest_.Insert(stops_.back().name, &stops_.back());
+    stop_buses_.resize(stops_.size());
+    stop_distances_.resize(stops_.size());
+    for (CatalogueObserver* observer : observers_) {
+        observer->OnStopAdded(stops_.back());
+    }
 }
 
-Stop* TransportCatalogue::FindStop(string_view name_stop) const {
-    auto stop_iter = stop_quest_.find(name_stop);
-    
-    if(stop_iter == stop_quest_.end()){
-        return nullptr;
+const Stop* TransportCatalogue::FindStop(string_view name_stop) const {
+    if (snapshot_) {
+        return snapshot_->FindStop(name_stop);
     }
-    return stop_iter->second;
+    Stop* const* stop = stop_quest_.Find(name_stop);
+    return stop == nullptr ? nullptr : *stop;
 }
 
-void TransportCatalogue::AddBus(const std::string& name, const std::vector<std::string>& stops, bool is_roundtrip) {
-    domain::Bus bus_new;
-    bus_new.name = move(name);
-    
+const Stop& TransportCatalogue::GetStop(StopId id) const {
+    if (snapshot_) {
+        return snapshot_->GetStop(id);
+    }
+    return stops_.at(id);
+}
+
+void TransportCatalogue::AddBus(string_view name, const vector<string_view>& stops, bool is_roundtrip) {
+    CheckNotFrozen();
+    BusRoute route;
+    route.stops.reserve(stops.size());
     for (const auto& stop_name : stops) {
-        domain::Stop* stop = FindStop(stop_name);
-        bus_new.stops.push_back(stop);
+        route.stops.push_back(static_cast<StopId>(FindStopIndex(stop_name)));
     }
     
+    domain::Bus bus_new;
+    bus_new.name = InternName(name);
     bus_new.is_roundtrip = is_roundtrip;
-    buses_.push_back(std::move(bus_new));
-    bus_quest_[buses_.back().name] = &buses_.back();
+    bus_new.id = static_cast<BusId>(buses_.size());
+    bus_routes_.push_back(std::move(route));
+    bus_new.stops = bus_routes_.back().stops;
+    ComputeBusStat(bus_new);
+    RemoveBus(bus_new.name);
+    // Прежний автобус остаётся в buses_, чтобы не инвалидировать ссылки на него
+    buses_.push_back(bus_new);
+    bus_quest_.Insert(buses_.back().name, &buses_.back());
+    is_sorted_buses_valid_ = false;
+    const auto by_name = [this](BusId lhs, BusId rhs) { return buses_[lhs].name < buses_[rhs].name; };
+    for (const StopId stop : buses_.back().stops) {
+        auto& buses = stop_buses_[stop];
+        const auto it = lower_bound(buses.begin(), buses.end(), bus_new.id, by_name);
+        if (it == buses.end() || *it != bus_new.id) {
+            buses.insert(it, bus_new.id);
+        }
+    }
+    for (CatalogueObserver* observer : observers_) {
+        observer->OnBusAdded(buses_.back());
+    }
 }
 
-Bus* TransportCatalogue::FindBus(string_view name_bus) const {
-    auto bus_iter = bus_quest_.find(name_bus);
-    
-    if(bus_iter == bus_quest_.end()) {
-        return nullptr;
+bool TransportCatalogue::RemoveBus(string_view name_bus) {
+    CheckNotFrozen();
+    const Bus* bus = FindBus(name_bus);
+    if (bus == nullptr) {
+        return false;
     }
-    return bus_iter->second;
+    for (CatalogueObserver* observer : observers_) {
+        observer->OnBusRemoved(*bus);
+    }
+    for (const StopId stop : bus->stops) {
+        auto& buses = stop_buses_[stop];
+        const auto it = find(buses.begin(), buses.end(), bus->id);
+        if (it != buses.end()) {
+            buses.erase(it);
+        }
+    }
+    bus_quest_.Erase(bus->name);
+    is_sorted_buses_valid_ = false;
+    return true;
 }
 
-set<string_view> TransportCatalogue::GetStopInfo(string_view name_stop) const {
-    auto stop = FindStop(name_stop);
-    set<string_view> buses_to_stop;
-    
-    if(stop == nullptr) {
-            return {};
-    } else {
-        for(auto& i : buses_){
-            if(find(i.stops.begin(), i.stops.end(), stop) != i.stops.end()) {
-                buses_to_stop.insert(i.name);
-            }
-        }
+const Bus* TransportCatalogue::FindBus(string_view name_bus) const {
+    if (snapshot_) {
+        return snapshot_->FindBus(name_bus);
     }
-    return buses_to_stop;
+    Bus* const* bus = bus_quest_.Find(name_bus);
+    return bus == nullptr ? nullptr : *bus;
+}
+
+const Bus& TransportCatalogue::GetBus(BusId id) const {
+    if (snapshot_) {
+        return snapshot_->GetBus(id);
+    }
+    return buses_.at(id);
+}
+
+ranges::Span<BusId> TransportCatalogue::GetStopInfo(string_view name_stop) const {
+    const Stop* stop = FindStop(name_stop);
+    if (stop == nullptr) {
+        return {};
+    }
+    return GetStopInfo(stop->id);
+}
+
+ranges::Span<BusId> TransportCatalogue::GetStopInfo(StopId id) const {
+    if (snapshot_) {
+        return snapshot_->GetStopBuses(id);
+    }
+    return stop_buses_.at(id);
 }
     
 void TransportCatalogue::AddDistance(string_view from_stop, string_view to_stop, int distance) {
-    distance_to_stops_[make_pair(FindStop(from_stop), FindStop(to_stop))] = distance;
+    CheckNotFrozen();
+    const Stop* from = FindStop(from_stop);
+    const Stop* to = FindStop(to_stop);
+    if (from == nullptr || to == nullptr) {
+        return;
+    }
+    AddDistance(from->id, to->id, distance);
+}
+
+void TransportCatalogue::AddDistance(StopId from, StopId to, int distance) {
+    CheckNotFrozen();
+    auto& distances = stop_distances_.at(from);
+    const auto it = lower_bound(distances.begin(), distances.end(), to,
+                                [](const RoadDistance& entry, StopId stop) { return entry.to < stop; });
+    if (it != distances.end() && it->to == to) {
+        it->distance = distance;
+    } else {
+        distances.insert(it, {to, distance});
+    }
+    // Перегон from → to есть только у автобусов, проходящих через from
+    for (const BusId bus : stop_buses_[from]) {
+        ComputeBusStat(buses_[bus]);
+    }
+    for (CatalogueObserver* observer : observers_) {
+        observer->OnDistanceChanged(stops_[from], stops_.at(to));
+    }
 }
     
 int TransportCatalogue::FindDistance(string_view from_stop, string_view to_stop) const {
-    auto stop1 = FindStop(from_stop);
-    auto stop2 = FindStop(to_stop);
-    auto dist = distance_to_stops_.find(make_pair(stop1, stop2));
-    
-    if(dist == distance_to_stops_.end()) {
-        auto dist2 = distance_to_stops_.find(make_pair(stop2, stop1));
-        
-        if(dist2 == distance_to_stops_.end()) {
-            return 0;
-        }
-        
-        return dist2->second;
+    const Stop* from = FindStop(from_stop);
+    const Stop* to = FindStop(to_stop);
+    if (from == nullptr || to == nullptr) {
+        return 0;
+    }
+    return FindDistance(from->id, to->id);
+}
+
+int TransportCatalogue::FindDistance(StopId from, StopId to) const {
+    const auto find = [this](StopId from, StopId to) -> const int* {
+        const auto distances = GetDistances(from);
+        const auto it = lower_bound(distances.begin(), distances.end(), to,
+                                    [](const RoadDistance& entry, StopId stop) { return entry.to < stop; });
+        return it != distances.end() && it->to == to ? &it->distance : nullptr;
+    };
+    if (const int* distance = find(from, to)) {
+        return *distance;
+    }
+    if (const int* distance = find(to, from)) {
+        return *distance;
+    }
+    return 0;
+}
+
+ranges::Span<RoadDistance> TransportCatalogue::GetDistances(StopId id) const {
+    if (snapshot_) {
+        return snapshot_->GetDistances(id);
     }
-    return dist->second;
+    return stop_distances_.at(id);
 }
     
 std::optional<BusStat> TransportCatalogue::GetBusInfo(const std::string_view& bus_name) const {
-    if(FindBus(bus_name) == nullptr) {
+    const Bus* bus = FindBus(bus_name);
+    if(bus == nullptr) {
         return {};
     }
-    domain::Bus bus = *FindBus(bus_name);
-    int fact_dist = 0;
-    double geo_dist = 0.0;
-    std::set<std::string_view> unique_stop;
-    
-    for(size_t i = 0; i < bus.stops.size(); ++i) {
-        unique_stop.insert(bus.stops[i]->name);
+    return bus->stat;
+}
 
-        if(i == 0) {
-            continue;
-        }
+const BusStat& TransportCatalogue::GetBusInfo(BusId id) const {
+    return GetBus(id).stat;
+}
+
+string_view TransportCatalogue::InternName(string_view name) {
+    if (const Stop* stop = FindStop(name)) {
+        return stop->name;
+    }
+    if (const Bus* bus = FindBus(name)) {
+        return bus->name;
+    }
+    return names_.Store(name);
+}
 
-        geo_dist += geo::ComputeDistance(bus.stops[i-1]->coord, bus.stops[i]->coord);
-        fact_dist += FindDistance(bus.stops[i-1]->name, bus.stops[i]->name);
+void TransportCatalogue::ComputeBusStat(Bus& bus) {
+    BusRoute& route = bus_routes_[bus.id];
+    route.road_distances.assign(bus.stops.size(), 0);
+    route.geo_distances.assign(bus.stops.size(), 0.0);
+    for(size_t i = 1; i < bus.stops.size(); ++i) {
+        route.geo_distances[i] = route.geo_distances[i - 1] + geo::ComputeDistance(stops_[bus.stops[i-1]].coord, stops_[bus.stops[i]].coord);
+        route.road_distances[i] = route.road_distances[i - 1] + FindDistance(bus.stops[i-1], bus.stops[i]);
     }
-    double curv = static_cast<double>(fact_dist) / geo_dist;
-    return std::optional<BusStat>{{curv, fact_dist, static_cast<int>(bus.stops.size()), static_cast<int>(unique_stop.size())}};
+    bus.road_distances = route.road_distances;
+    bus.geo_distances = route.geo_distances;
+
+    std::vector<StopId> unique_stops(bus.stops.begin(), bus.stops.end());
+    std::sort(unique_stops.begin(), unique_stops.end());
+    unique_stops.erase(std::unique(unique_stops.begin(), unique_stops.end()), unique_stops.end());
+
+    const int fact_dist = bus.road_distances.empty() ? 0 : bus.road_distances.back();
+    const double geo_dist = bus.geo_distances.empty() ? 0.0 : bus.geo_distances.back();
+    bus.stat = {static_cast<double>(fact_dist) / geo_dist, fact_dist,
+                static_cast<int>(bus.stops.size()), static_cast<int>(unique_stops.size())};
 }
     
-std::set<Stop*> TransportCatalogue::GetStopsInRoutes() const {
-    std::set<Stop*> stops_in_routes;
-    for (const auto& [name, bus] : bus_quest_) {
+std::set<const Stop*> TransportCatalogue::GetStopsInRoutes() const {
+    std::set<const Stop*> stops_in_routes;
+    for (const auto& [name, bus] : GetAllBuses()) {
         if(bus->stops.empty()) continue;
         
-        for (const auto& stop : bus->stops) {
-            if(FindStop(stop->name) == nullptr) continue;
-            stops_in_routes.insert(stop);
+        for (const StopId stop : bus->stops) {
+            stops_in_routes.insert(&GetStop(stop));
         }
     }
     return stops_in_routes;
 }
 
-    const std::map<std::string_view, Bus*>& TransportCatalogue::GetAllBuses() const{
-        return bus_quest_;
+    const std::vector<std::pair<std::string_view, const Bus*>>& TransportCatalogue::GetAllBuses() const{
+        if (snapshot_) {
+            return snapshot_->GetAllBuses();
+        }
+        if (!is_sorted_buses_valid_) {
+            sorted_buses_.assign(bus_quest_.begin(), bus_quest_.end());
+            sort(sorted_buses_.begin(), sorted_buses_.end());
+            is_sorted_buses_valid_ = true;
+        }
+        return sorted_buses_;
     }
     
-const std::unordered_map<std::string_view, Stop*>& TransportCatalogue::GetAllStops() const {
-        return stop_quest_;
-    }
+size_t TransportCatalogue::GetStopCount() const {
+    return snapshot_ ? snapshot_->GetStopCount() : stops_.size();
+}
+
+size_t TransportCatalogue::GetBusCount() const {
+    return snapshot_ ? snapshot_->GetBusCount() : buses_.size();
+}
     
-size_t TransportCatalogue::FindStopIndex(const std::string& stop_name) const {
-    auto it = stop_to_index_.find(stop_name);
-    if (it != stop_to_index_.end()) {
-        return it->second;
+size_t TransportCatalogue::FindStopIndex(string_view stop_name) const {
+    if (const Stop* stop = FindStop(stop_name)) {
+        return stop->id;
     }
-    throw std::out_of_range("Stop not found in stop_to_index"s);
+    throw std::out_of_range("Stop not found"s);
 }
     
 std::string_view TransportCatalogue::GetStopToIndex (size_t id) const {
-    return stops_[id].name;
+    return GetStop(static_cast<StopId>(id)).name;
+}
+
+size_t TransportCatalogue::FindBusIndex(std::string_view bus_name) const {
+    if (const Bus* bus = FindBus(bus_name)) {
+        return bus->id;
+    }
+    throw std::out_of_range("Bus not found"s);
+}
+
+std::string_view TransportCatalogue::GetBusToIndex(size_t id) const {
+    return GetBus(static_cast<BusId>(id)).name;
 }
     
+void TransportCatalogue::AddObserver(CatalogueObserver* observer) {
+    observers_.push_back(observer);
+}
+
+void TransportCatalogue::RemoveObserver(CatalogueObserver* observer) {
+    observers_.erase(std::remove(observers_.begin(), observers_.end(), observer), observers_.end());
+}
+
+void TransportCatalogue::Freeze() {
+    if (snapshot_) {
+        return;
+    }
+    auto snapshot = std::make_unique<CatalogueSnapshot>(*this);
+    snapshot_ = std::move(snapshot);
+    // Снимок хранит свои копии имён и массивов, структуры для изменений больше не нужны
+    names_ = StringArena{};
+    stops_ = {};
+    stop_quest_ = {};
+    buses_ = {};
+    bus_routes_ = {};
+    bus_quest_ = {};
+    sorted_buses_ = {};
+    stop_buses_ = {};
+    stop_distances_ = {};
+}
+
+bool TransportCatalogue::IsFrozen() const {
+    return snapshot_ != nullptr;
+}
+
+void TransportCatalogue::LoadSnapshot(const string& path) {
+    CheckNotFrozen();
+    if (!stops_.empty() || !buses_.empty()) {
+        throw logic_error("Catalogue is not empty"s);
+    }
+    snapshot_ = make_unique<CatalogueSnapshot>(path);
+}
+
+void TransportCatalogue::SaveSnapshot(ostream& output) const {
+    if (!snapshot_) {
+        throw logic_error("Catalogue is not frozen"s);
+    }
+    snapshot_->Save(output);
+}
+
+uint64_t TransportCatalogue::GetSnapshotChecksum() const {
+    if (!snapshot_) {
+        throw logic_error("Catalogue is not frozen"s);
+    }
+    return snapshot_->GetChecksum();
+}
+
+size_t TransportCatalogue::GetSnapshotMemoryUsage() const {
+    return snapshot_ ? snapshot_->GetMemoryUsage() : 0;
+}
+
+void TransportCatalogue::CheckNotFrozen() const {
+    if (snapshot_) {
+        throw std::logic_error("Catalogue is frozen"s);
+    }
+}
+
 }
\ No newline at end of file
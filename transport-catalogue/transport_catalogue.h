@@ -1,66 +1,154 @@
 #pragma once
 
+#include <cstdint>
 #include <deque>
-#include <map>
+#include <iostream>
+#include <memory>
 #include <optional>
 #include <set>
 #include <string>
 #include <string_view>
 #include <vector>
-#include <unordered_map>
 #include <utility>
 
 #include "geo.h"
+#include "catalogue_snapshot.h"
 #include "domain.h"
+#include "flat_hash_map.h"
+#include "ranges.h"
+#include "string_arena.h"
 
 namespace catalogue {
 
 using namespace domain;
     
-template<typename T>
-class HashPairPoint {
+// Получатель уведомлений об изменениях каталога. Уведомление приходит после изменения,
+// OnBusRemoved — до того, как автобус исчезнет из каталога.
+class CatalogueObserver {
 public:
-    size_t operator()(const std::pair<T*, T*>& points) const {
-        return hasher_(points.first)+ hasher_(points.second) * 37;
-    }
-private:
-    std::hash<const T*> hasher_;
+    virtual void OnStopAdded(const Stop& stop) = 0;
+    virtual void OnDistanceChanged(const Stop& from, const Stop& to) = 0;
+    virtual void OnBusAdded(const Bus& bus) = 0;
+    virtual void OnBusRemoved(const Bus& bus) = 0;
+
+protected:
+    ~CatalogueObserver() = default;
 };
 
+// Изменения (AddStop, AddDistance, AddBus, RemoveBus) возможны только до Freeze,
+// после него они бросают std::logic_error
 class TransportCatalogue {
 public:
+    // Имя остановки копируется в арену каталога
     void AddStop(const Stop& stop_new);
     
-    Stop* FindStop(std::string_view name_stop) const;
+    const Stop* FindStop(std::string_view name_stop) const;
+
+    const Stop& GetStop(StopId id) const;
     
-    void AddBus(const std::string& name, const std::vector<std::string>& stops, bool is_roundtrip);
+    // Автобус с уже существующим именем заменяет прежний. Имена нужны только на время вызова
+    void AddBus(std::string_view name, const std::vector<std::string_view>& stops, bool is_roundtrip);
+
+    // Возвращает false, если автобуса нет
+    bool RemoveBus(std::string_view name_bus);
     
-    Bus* FindBus(std::string_view name_bus) const;
+    const Bus* FindBus(std::string_view name_bus) const;
+
+    // Доступен и заменённый или удалённый автобус
+    const Bus& GetBus(BusId id) const;
     
-    std::set<std::string_view> GetStopInfo(std::string_view name_stop) const;
+    // id автобусов, проходящих через остановку, по возрастанию имени; пусто, если остановки нет
+    ranges::Span<BusId> GetStopInfo(std::string_view name_stop) const;
+    ranges::Span<BusId> GetStopInfo(StopId id) const;
     
+    // Расстояние до неизвестной остановки не сохраняется
     void AddDistance(std::string_view from_stop, std::string_view to_stop, int distance);
+    void AddDistance(StopId from, StopId to, int distance);
     
+    // Если расстояние from → to не задано, берётся to → from, иначе 0
     int FindDistance(std::string_view from_stop, std::string_view to_stop)const;
+    int FindDistance(StopId from, StopId to) const;
+
+    // Заданные дорожные расстояния из остановки по возрастанию id остановки назначения
+    ranges::Span<RoadDistance> GetDistances(StopId id) const;
     
+    // Статистика считается при добавлении автобуса и при изменении расстояний на его пути
     std::optional<BusStat> GetBusInfo(const std::string_view& bus_name) const;
+    const BusStat& GetBusInfo(BusId id) const;
     
-    std::set<Stop*> GetStopsInRoutes() const;
+    std::set<const Stop*> GetStopsInRoutes() const;
 
-    const std::map<std::string_view, Bus*>& GetAllBuses() const;
+    // Действующие автобусы по возрастанию имени. Список сортируется при первом обращении
+    // после изменения автобусов, ссылка на него остаётся той же
+    const std::vector<std::pair<std::string_view, const Bus*>>& GetAllBuses() const;
     
-    const std::unordered_map<std::string_view, Stop*>& GetAllStops() const;
+    size_t GetStopCount() const;
+
+    // Число id автобусов, включая заменённые и удалённые
+    size_t GetBusCount() const;
     
-    size_t FindStopIndex(const std::string& stop_name) const;
+    size_t FindStopIndex(std::string_view stop_name) const;
     
     std::string_view GetStopToIndex (size_t id) const;
+
+    // Индекс автобуса в порядке добавления. Заменённые и удалённые автобусы сохраняют
+    // свои индексы, так что имя по индексу остаётся доступным
+    size_t FindBusIndex(std::string_view bus_name) const;
+
+    std::string_view GetBusToIndex(size_t id) const;
+
+    void AddObserver(CatalogueObserver* observer);
+    void RemoveObserver(CatalogueObserver* observer);
+
+    // Собирает неизменяемый снимок (catalogue_snapshot.h) и освобождает структуры для изменений:
+    // дальше все запросы читают снимок. Ссылки и указатели на остановки и автобусы,
+    // полученные до Freeze, становятся недействительными
+    void Freeze();
+
+    bool IsFrozen() const;
+
+    // Заполняет пустой каталог снимком из файла, записанного SaveSnapshot, и замораживает его.
+    // Файл отображается в память и читается без разбора; ошибки чтения — std::runtime_error
+    void LoadSnapshot(const std::string& path);
+
+    // Записывает снимок замороженного каталога; для незамороженного бросает std::logic_error
+    void SaveSnapshot(std::ostream& output) const;
+
+    // Контрольная сумма снимка замороженного каталога, меняется вместе с его содержимым
+    uint64_t GetSnapshotChecksum() const;
+
+    // Байты снимка, если каталог заморожен, иначе 0
+    size_t GetSnapshotMemoryUsage() const;
 private:
+    // Остановки автобуса и накопленные расстояния, на которые ссылается Bus до Freeze
+    struct BusRoute {
+        std::vector<StopId> stops;
+        std::vector<int> road_distances;
+        std::vector<double> geo_distances;
+    };
+
+    // Имена остановок и автобусов; на них указывают ключи индексов ниже
+    StringArena names_;
     std::deque<Stop> stops_;
-    std::unordered_map<std::string_view, Stop*> stop_quest_;
+    containers::FlatHashMap<std::string_view, Stop*, containers::StringHash> stop_quest_;
     std::deque<Bus> buses_;
-    std::map<std::string_view, Bus*> bus_quest_;
-    std::unordered_map<std::pair<Stop*, Stop*>, int, HashPairPoint<Stop>> distance_to_stops_;
-    std::unordered_map<std::string_view, size_t> stop_to_index_;
+    std::deque<BusRoute> bus_routes_;
+    containers::FlatHashMap<std::string_view, Bus*, containers::StringHash> bus_quest_;
+    mutable std::vector<std::pair<std::string_view, const Bus*>> sorted_buses_;
+    mutable bool is_sorted_buses_valid_ = true;
+    // Обратный индекс «остановка → автобусы» по индексу остановки, поддерживается в AddBus и RemoveBus
+    std::vector<std::vector<BusId>> stop_buses_;
+    // Дорожные расстояния из каждой остановки по её id, по возрастанию id остановки назначения
+    std::vector<std::vector<RoadDistance>> stop_distances_;
+    std::vector<CatalogueObserver*> observers_;
+    std::unique_ptr<CatalogueSnapshot> snapshot_;
+
+    void CheckNotFrozen() const;
+
+    // Имя из арены: уже известное имя остановки или автобуса переиспользуется, новое копируется в арену
+    std::string_view InternName(std::string_view name);
+    // Заполняет накопленные расстояния и статистику автобуса
+    void ComputeBusStat(Bus& bus);
 };
     
 }
\ No newline at end of file
@@ -1,10 +1,162 @@
 #include "transport_router.h"
 
+#include "parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+
 namespace router{
 
-    TransportRouter::TransportRouter(const catalogue::TransportCatalogue& catalogue, RoutingSettings settings)
-        : routing_settings_(std::move(settings)), graph_(BuildGraph(catalogue)) {
-        router_ = std::make_unique<graph::Router<double>>(graph_);
+namespace {
+
+// Формат файла маршрутизатора: заголовок, затем секции рёбер графа, остановок вершин
+// и (для движка ALL_PAIRS) весов и последних рёбер таблицы маршрутов. Каждая секция
+// выровнена по SECTION_ALIGNMENT, таблица используется прямо из отображённой памяти.
+// Числа хранятся в порядке байтов машины, записавшей файл.
+constexpr char ROUTER_FILE_MAGIC[8] = {'T', 'C', 'R', 'O', 'U', 'T', 'E', 'R'};
+constexpr uint32_t ROUTER_FILE_VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint32_t NO_TABLE = std::numeric_limits<uint32_t>::max();
+constexpr uint64_t SECTION_ALIGNMENT = 64;
+
+struct RouterFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint64_t key;
+    uint64_t file_size;
+    uint64_t vertex_count;
+    uint64_t edge_count;
+    // Значение TableWeight или NO_TABLE
+    uint32_t table_weight;
+    uint32_t graph_model;
+    uint64_t edges_offset;
+    uint64_t vertex_stops_offset;
+    uint64_t table_weights_offset;
+    uint64_t table_prev_edges_offset;
+};
+
+struct StoredEdge {
+    uint64_t from;
+    uint64_t to;
+    double weight;
+    // Позиция автобуса в TransportCatalogue::GetAllBuses
+    uint32_t bus_index;
+    int32_t span_count;
+};
+
+using CompactEdgeId = graph::RouteTable<double>::CompactEdgeId;
+
+uint64_t AlignSection(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+size_t GetStoredWeightSize(TableWeight table_weight) {
+    switch (table_weight) {
+        case TableWeight::FLOAT:
+            return sizeof(float);
+        case TableWeight::FIXED_POINT:
+            return sizeof(uint32_t);
+        case TableWeight::DOUBLE:
+            break;
+    }
+    return sizeof(double);
+}
+
+// Указатель на секцию из count элементов или nullptr, если она выходит за файл
+template <typename T>
+const T* GetSection(const io::MappedFile& file, uint64_t offset, uint64_t count) {
+    if (offset % alignof(T) != 0 || offset > file.GetSize()
+        || count > (file.GetSize() - offset) / sizeof(T)) {
+        return nullptr;
+    }
+    return reinterpret_cast<const T*>(file.GetData() + offset);
+}
+
+class SectionWriter {
+public:
+    explicit SectionWriter(std::ostream& output)
+        : output_(output) {
+    }
+
+    void Write(const void* data, size_t size) {
+        output_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position_ += size;
+    }
+
+    void PadTo(uint64_t offset) {
+        static const char ZEROS[SECTION_ALIGNMENT] = {};
+        while (position_ < offset) {
+            Write(ZEROS, std::min<uint64_t>(offset - position_, SECTION_ALIGNMENT));
+        }
+    }
+
+private:
+    std::ostream& output_;
+    uint64_t position_ = 0;
+};
+
+template <typename StoredWeight>
+void WriteRouteTable(SectionWriter& writer, const graph::RoutingEngine<double>& engine,
+                     const RouterFileHeader& header) {
+    const auto& table = dynamic_cast<const graph::Router<double, StoredWeight>&>(engine).GetRouteTable();
+    const size_t cell_count = header.vertex_count * header.vertex_count;
+    writer.PadTo(header.table_weights_offset);
+    writer.Write(table.GetWeights(0), cell_count * sizeof(StoredWeight));
+    writer.PadTo(header.table_prev_edges_offset);
+    writer.Write(table.GetPrevEdges(0), cell_count * sizeof(CompactEdgeId));
+}
+
+template <typename StoredWeight>
+std::unique_ptr<graph::RoutingEngine<double>> MakeMappedRouter(const graph::DirectedWeightedGraph<double>& graph,
+                                                               const io::MappedFile& file,
+                                                               const RouterFileHeader& header) {
+    const uint64_t cell_count = header.vertex_count * header.vertex_count;
+    const auto* weights = GetSection<StoredWeight>(file, header.table_weights_offset, cell_count);
+    const auto* prev_edges = GetSection<CompactEdgeId>(file, header.table_prev_edges_offset, cell_count);
+    if (weights == nullptr || prev_edges == nullptr) {
+        return nullptr;
+    }
+    return std::make_unique<graph::Router<double, StoredWeight>>(
+        graph, graph::RouteTable<StoredWeight>::FromView(header.vertex_count, weights, prev_edges));
+}
+
+}  // namespace
+
+    TransportRouter::TransportRouter(const catalogue::TransportCatalogue& catalogue, RoutingSettings settings,
+                                     std::optional<RouterFileSettings> file_settings)
+        : routing_settings_(std::move(settings))
+        , route_cache_(routing_settings_.route_cache_size) {
+        auto start = std::chrono::steady_clock::now();
+        // RAPTOR обходится без графа, поэтому и без файла маршрутизатора
+        if (routing_settings_.engine == RouterEngine::RAPTOR) {
+            raptor_ = CreateRaptor(catalogue);
+            engine_build_time_ = std::chrono::steady_clock::now() - start;
+            return;
+        }
+        if (file_settings && LoadFromFile(*file_settings, catalogue)) {
+            route_file_status_ = "loaded";
+            return;
+        }
+        start = std::chrono::steady_clock::now();
+
+        graph_ = BuildGraph(catalogue);
+        graph_.Freeze();
+        IndexBusEdges(catalogue);
+        graph_build_time_ = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        router_ = CreateEngine(catalogue);
+        engine_build_time_ = std::chrono::steady_clock::now() - start;
+
+        if (file_settings) {
+            SaveToFile(*file_settings, catalogue);
+            route_file_status_ = "saved";
+        }
     }
 
     const RoutingSettings& TransportRouter::GetRoutingSettings() const {
@@ -13,43 +165,894 @@ namespace router{
     }
 
     const std::optional<RouteInfo> TransportRouter::BuildRoute (const std::string& from, const std::string& to, const catalogue::TransportCatalogue& catalogue) const {
-        if (!router_) {
+        return BuildRoutes(from, {to}, catalogue).front();
+    }
+
+    std::vector<std::optional<RouteInfo>> TransportRouter::BuildRoutes(const std::string& from, const std::vector<std::string>& targets,
+                                                                       const catalogue::TransportCatalogue& catalogue) const {
+        if (!router_ && !raptor_) {
             throw std::logic_error("Router is not initialized");
         }
 
-        auto route = router_->BuildRoute(catalogue.FindStopIndex(from), catalogue.FindStopIndex(to));
-        if (!route) {
-            return std::nullopt;
+        const graph::VertexId from_vertex = catalogue.FindStopIndex(from);
+        const auto start = std::chrono::steady_clock::now();
+        // Повторяющиеся в пакете цели считаются один раз
+        std::vector<graph::VertexId> unique_vertices;
+        std::vector<size_t> target_slots;
+        target_slots.reserve(targets.size());
+        std::unordered_map<graph::VertexId, size_t> vertex_slots;
+        for (const auto& to : targets) {
+            const auto [it, inserted] = vertex_slots.emplace(catalogue.FindStopIndex(to), unique_vertices.size());
+            if (inserted) {
+                unique_vertices.push_back(it->first);
+            }
+            target_slots.push_back(it->second);
         }
 
-        std::vector<graph::Edge<double>> edges;
-        for (const auto& edge_id : route->edges) {
-            edges.push_back(graph_.GetEdge(edge_id));
+        std::vector<std::optional<RouteInfo>> unique_routes(unique_vertices.size());
+        // Цели, маршрутов до которых нет в кэше, и их номера среди уникальных
+        std::vector<graph::VertexId> missed_vertices;
+        std::vector<size_t> missed_slots;
+        for (size_t slot = 0; slot < unique_vertices.size(); ++slot) {
+            if (route_cache_.GetCapacity() > 0) {
+                if (const auto* cached = route_cache_.Find({from_vertex, unique_vertices[slot]})) {
+                    unique_routes[slot] = *cached;
+                    continue;
+                }
+            }
+            missed_vertices.push_back(unique_vertices[slot]);
+            missed_slots.push_back(slot);
+        }
+
+        if (!missed_vertices.empty() && raptor_) {
+            auto routes = raptor_->BuildRoutes(from_vertex, missed_vertices);
+            for (size_t j = 0; j < routes.size(); ++j) {
+                auto& route = unique_routes[missed_slots[j]];
+                route = std::move(routes[j]);
+                route_cache_.Insert({from_vertex, missed_vertices[j]}, route);
+            }
+        } else if (!missed_vertices.empty()) {
+            auto routes = router_->BuildRoutes(from_vertex, missed_vertices);
+            for (size_t j = 0; j < routes.size(); ++j) {
+                auto& route = unique_routes[missed_slots[j]];
+                if (routes[j]) {
+                    route = MakeRouteInfo(*routes[j], catalogue);
+                }
+                route_cache_.Insert({from_vertex, missed_vertices[j]}, route);
+            }
+        }
+
+        std::vector<std::optional<RouteInfo>> result;
+        result.reserve(targets.size());
+        for (const size_t slot : target_slots) {
+            result.push_back(unique_routes[slot]);
+        }
+        query_time_ += std::chrono::steady_clock::now() - start;
+        query_count_ += targets.size();
+        return result;
+    }
+
+    std::vector<RouteInfo> TransportRouter::BuildAlternatives(const std::string& from, const std::string& to,
+                                                              const catalogue::TransportCatalogue& catalogue) const {
+        if (!raptor_) {
+            std::vector<RouteInfo> routes;
+            if (auto route = BuildRoute(from, to, catalogue)) {
+                routes.push_back(std::move(*route));
+            }
+            return routes;
         }
-        return RouteInfo{route->weight, std::move(edges)};
+
+        const auto start = std::chrono::steady_clock::now();
+        auto routes = raptor_->BuildAlternatives(catalogue.FindStopIndex(from), catalogue.FindStopIndex(to));
+        query_time_ += std::chrono::steady_clock::now() - start;
+        ++query_count_;
+        return routes;
     }
 
-    graph::DirectedWeightedGraph<double> TransportRouter::BuildGraph(const catalogue::TransportCatalogue& catalogue) const {
-    graph::DirectedWeightedGraph<double> graph(catalogue.GetAllStops().size());
+    std::vector<std::optional<double>> TransportRouter::BuildTimeMatrix(const std::vector<std::string>& sources, const std::vector<std::string>& targets,
+                                                                        const catalogue::TransportCatalogue& catalogue) const {
+        if (!router_ && !raptor_) {
+            throw std::logic_error("Router is not initialized");
+        }
+
+        const auto to_vertices = [&catalogue](const std::vector<std::string>& stops) {
+            std::vector<graph::VertexId> vertices;
+            vertices.reserve(stops.size());
+            for (const auto& stop : stops) {
+                vertices.push_back(catalogue.FindStopIndex(stop));
+            }
+            return vertices;
+        };
+        const auto source_vertices = to_vertices(sources);
+        const auto target_vertices = to_vertices(targets);
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::optional<double>> times;
+        if (raptor_) {
+            times.reserve(source_vertices.size() * target_vertices.size());
+            for (const graph::VertexId from : source_vertices) {
+                for (const auto& route : raptor_->BuildRoutes(from, target_vertices)) {
+                    times.push_back(route ? std::optional<double>{route->full_time} : std::nullopt);
+                }
+            }
+        } else {
+            times = router_->BuildWeightMatrix(source_vertices, target_vertices);
+        }
+        query_time_ += std::chrono::steady_clock::now() - start;
+        query_count_ += times.size();
+        return times;
+    }
+
+    std::vector<ReachableStop> TransportRouter::FindReachableStops(const std::string& from, double max_time,
+                                                                   const catalogue::TransportCatalogue& catalogue) const {
+        std::vector<ReachableStop> stops;
+        if (raptor_) {
+            const auto times = raptor_->FindArrivalTimes(catalogue.FindStopIndex(from), max_time);
+            for (size_t stop_index = 0; stop_index < times.size(); ++stop_index) {
+                if (times[stop_index]) {
+                    stops.push_back({stop_index, *times[stop_index]});
+                }
+            }
+            std::stable_sort(stops.begin(), stops.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+                return lhs.time < rhs.time;
+            });
+            return stops;
+        }
+        for (const auto& [vertex, time] : graph::FindReachableVertices(graph_, catalogue.FindStopIndex(from), max_time)) {
+            if (IsStopVertex(vertex)) {
+                stops.push_back({vertex, time});
+            }
+        }
+        return stops;
+    }
+
+    std::optional<PointRouteInfo> TransportRouter::BuildPointRoute(const std::vector<spatial::NearbyStop>& from_stops,
+                                                                   const std::vector<spatial::NearbyStop>& to_stops,
+                                                                   std::optional<double> direct_distance,
+                                                                   const catalogue::TransportCatalogue& catalogue) const {
+        if (!router_ && !raptor_) {
+            throw std::logic_error("Router is not initialized");
+        }
+        const auto to_walk_times = [this](const std::vector<spatial::NearbyStop>& stops) {
+            std::vector<std::pair<graph::VertexId, double>> times;
+            times.reserve(stops.size());
+            for (const auto& [stop, distance] : stops) {
+                times.emplace_back(stop, ComputeWalkTime(distance));
+            }
+            return times;
+        };
+        const auto find_distance = [](const std::vector<spatial::NearbyStop>& stops, size_t stop) {
+            return std::find_if(stops.begin(), stops.end(), [stop](const auto& nearby) { return nearby.id == stop; })->distance;
+        };
+        const auto start = std::chrono::steady_clock::now();
+
+        // Поездки и концевые остановки лучшего маршрута с транспортом
+        std::optional<RouteInfo> rides_route;
+        size_t first_stop = 0;
+        size_t last_stop = 0;
+        if (raptor_) {
+            std::vector<std::pair<size_t, double>> sources;
+            std::vector<std::pair<size_t, double>> targets;
+            for (const auto& [stop, time] : to_walk_times(from_stops)) {
+                sources.emplace_back(stop, time);
+            }
+            for (const auto& [stop, time] : to_walk_times(to_stops)) {
+                targets.emplace_back(stop, time);
+            }
+            if (auto found = raptor_->BuildMultiStopRoute(sources, targets)) {
+                last_stop = found->first;
+                rides_route = std::move(found->second);
+                first_stop = rides_route->rides.empty() ? last_stop : rides_route->rides.front().from;
+            }
+        } else if (const auto found = graph::FindBestMultiPointRoute(graph_, to_walk_times(from_stops), to_walk_times(to_stops))) {
+            first_stop = found->source;
+            last_stop = found->target;
+            rides_route = MakeRouteInfo({found->weight, found->edges}, catalogue);
+        }
+
+        std::optional<PointRouteInfo> route;
+        if (rides_route) {
+            const auto walk_to_stop = MakeWalk(find_distance(from_stops, first_stop));
+            const auto walk_from_stop = MakeWalk(find_distance(to_stops, last_stop));
+            double full_time = 0.0;
+            for (const auto& ride : rides_route->rides) {
+                full_time += ride.time;
+            }
+            full_time += (walk_to_stop ? walk_to_stop->time : 0.0) + (walk_from_stop ? walk_from_stop->time : 0.0);
+            route = PointRouteInfo{full_time, walk_to_stop, std::move(rides_route->rides), walk_from_stop};
+        }
+        // Пешком целиком, если так не дольше
+        if (direct_distance && (!route || ComputeWalkTime(*direct_distance) <= route->full_time)) {
+            route = PointRouteInfo{ComputeWalkTime(*direct_distance), MakeWalk(*direct_distance), {}, std::nullopt};
+        }
+        query_time_ += std::chrono::steady_clock::now() - start;
+        ++query_count_;
+        return route;
+    }
+
+    RouteInfo TransportRouter::MakeRouteInfo(const graph::RoutingEngine<double>::RouteInfo& route,
+                                             const catalogue::TransportCatalogue& catalogue) const {
+        if (routing_settings_.graph_model == GraphModel::LINEAR) {
+            return RouteInfo{route.weight, CollapseLinearRoute(route.edges, catalogue)};
+        }
+        std::vector<RideInfo> rides;
+        for (const auto& edge_id : route.edges) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            rides.push_back({edge.from, edge.to, edge.weight, catalogue.GetBusToIndex(edge.bus_id), edge.span_count});
+        }
+        return RouteInfo{route.weight, std::move(rides)};
+    }
+
+    std::unique_ptr<graph::RoutingEngine<double>> TransportRouter::CreateEngine(
+        const catalogue::TransportCatalogue& catalogue) const {
+        switch (routing_settings_.engine) {
+            case RouterEngine::ASTAR:
+                return std::make_unique<graph::AStarRouter<double>>(
+                    graph_, CreateLowerBound(catalogue), graph::AStarMode::UNIDIRECTIONAL);
+            case RouterEngine::BIDIRECTIONAL_ASTAR:
+                return std::make_unique<graph::AStarRouter<double>>(
+                    graph_, CreateLowerBound(catalogue), graph::AStarMode::BIDIRECTIONAL);
+            case RouterEngine::DIJKSTRA:
+                return std::make_unique<graph::DijkstraRouter<double>>(graph_, routing_settings_.heap_type);
+            case RouterEngine::CONTRACTION_HIERARCHY:
+                return std::make_unique<graph::ContractionHierarchy<double>>(graph_);
+            case RouterEngine::RAPTOR:
+                throw std::logic_error("RAPTOR does not use the route graph");
+            case RouterEngine::ALL_PAIRS:
+                break;
+        }
+        const size_t thread_count = parallel::ResolveThreadCount(routing_settings_.precompute_threads, graph_.GetVertexCount());
+        switch (routing_settings_.table_weight) {
+            case TableWeight::FLOAT:
+                return std::make_unique<graph::Router<double, float>>(graph_, thread_count, routing_settings_.relax_kernel);
+            case TableWeight::FIXED_POINT:
+                return std::make_unique<graph::Router<double, uint32_t>>(graph_, thread_count, routing_settings_.relax_kernel);
+            case TableWeight::DOUBLE:
+                break;
+        }
+        return std::make_unique<graph::Router<double>>(graph_, thread_count, routing_settings_.relax_kernel);
+    }
+
+    double TransportRouter::ComputeLowerBoundScale(const catalogue::TransportCatalogue& catalogue) const {
+        // Дорожное расстояние может быть меньше расстояния по прямой, поэтому оценка
+        // домножается на наименьшее их отношение по всем перегонам. Запас компенсирует
+        // погрешность вычисления расстояния по прямой.
+        constexpr double SAFETY_FACTOR = 1.0 - 1e-6;
+        double scale = 1.0;
         for (const auto& [_, bus] : catalogue.GetAllBuses()) {
-            const auto& stops = bus->stops;
-            for (size_t i = 0; i < stops.size(); ++i) {
-                int stop_count = 0;
-                double cumulative_distance = 0.0;
-                for (size_t j = i + 1; j < stops.size(); ++j) {
-                    cumulative_distance += catalogue.FindDistance(stops[j - 1]->name, stops[j]->name);
-                    double travel_time = cumulative_distance / (routing_settings_.bus_velocity * KM_TO_METERS / MINUTES_IN_HOUR);
-                    ++stop_count;
-                    graph.AddEdge({
-                        catalogue.FindStopIndex(stops[i]->name),
-                        catalogue.FindStopIndex(stops[j]->name),
-                        routing_settings_.bus_wait_time + travel_time,
-                        bus->name,
-                        stop_count
-                    });
+            for (size_t i = 0; i + 1 < bus->stops.size(); ++i) {
+                const double geo_distance = geo::ComputeDistance(catalogue.GetStop(bus->stops[i]).coord,
+                                                                catalogue.GetStop(bus->stops[i + 1]).coord);
+                if (geo_distance > 0.0) {
+                    const double road_distance = bus->road_distances[i + 1] - bus->road_distances[i];
+                    scale = std::min(scale, road_distance / geo_distance);
                 }
             }
         }
+        return scale * SAFETY_FACTOR;
+    }
+
+    graph::LowerBound<double> TransportRouter::CreateLowerBound(const catalogue::TransportCatalogue& catalogue) const {
+        // Длина хорды не больше длины дуги большого круга и, в отличие от неё, считается
+        // без тригонометрии: точки заранее переводятся в трёхмерные координаты
+        struct Point {
+            double x;
+            double y;
+            double z;
+        };
+        constexpr double EARTH_RADIUS = 6371000.0;
+        constexpr double DEGREES_TO_RADIANS = 3.14159265358979323846 / 180.0;
+        std::vector<Point> vertex_points(vertex_stops_.size());
+        for (size_t vertex = 0; vertex < vertex_stops_.size(); ++vertex) {
+            const geo::Coordinates coord = catalogue.GetStop(static_cast<domain::StopId>(vertex_stops_[vertex])).coord;
+            const double lat = coord.lat * DEGREES_TO_RADIANS;
+            const double lng = coord.lng * DEGREES_TO_RADIANS;
+            vertex_points[vertex] = {EARTH_RADIUS * std::cos(lat) * std::cos(lng),
+                                     EARTH_RADIUS * std::cos(lat) * std::sin(lng),
+                                     EARTH_RADIUS * std::sin(lat)};
+        }
+        // Минут на метр пути по прямой
+        const double minutes_per_meter = ComputeLowerBoundScale(catalogue) * ComputeTravelTime(1.0);
+        // Любой путь из остановки в другую вершину начинается с посадки, то есть с ожидания
+        const double wait_time = routing_settings_.bus_wait_time;
+        const size_t stop_count = catalogue.GetStopCount();
+        return [vertex_points = std::move(vertex_points), minutes_per_meter, wait_time, stop_count](
+                   graph::VertexId from, graph::VertexId to) {
+            if (from == to) {
+                return 0.0;
+            }
+            const Point& lhs = vertex_points[from];
+            const Point& rhs = vertex_points[to];
+            const double distance = std::sqrt((lhs.x - rhs.x) * (lhs.x - rhs.x) + (lhs.y - rhs.y) * (lhs.y - rhs.y)
+                                              + (lhs.z - rhs.z) * (lhs.z - rhs.z));
+            return distance * minutes_per_meter + (from < stop_count ? wait_time : 0.0);
+        };
+    }
+
+    void TransportRouter::ReportStats(std::ostream& output) const {
+        const size_t graph_memory = graph_.GetEdgeCount() * sizeof(graph::Edge<double>)
+                                  + (graph_.GetVertexCount() + 1) * sizeof(graph::EdgeId);
+        output << "router: vertices=" << graph_.GetVertexCount()
+               << " edges=" << graph_.GetEdgeCount()
+               << " graph_bytes=" << graph_memory
+               << " engine_bytes=" << (router_ ? router_->GetMemoryUsage() : raptor_ ? raptor_->GetMemoryUsage() : 0)
+               << " graph_build_ms=" << graph_build_time_.count()
+               << " engine_build_ms=" << engine_build_time_.count()
+               << " route_file=" << route_file_status_
+               << " updates=" << update_count_
+               << " update_ms=" << update_time_.count()
+               << " engine_rebuilds=" << engine_rebuild_count_
+               << " queries=" << query_count_
+               << " avg_query_us=" << (query_count_ == 0 ? 0.0 : query_time_.count() * 1000.0 / query_count_)
+               << " route_cache=" << route_cache_.GetSize() << "/" << route_cache_.GetCapacity()
+               << " cache_hits=" << route_cache_.GetHitCount()
+               << " cache_misses=" << route_cache_.GetMissCount()
+               << std::endl;
+        if (router_) {
+            router_->PrintStats(output);
+        }
+        if (raptor_) {
+            raptor_->PrintStats(output);
+        }
+    }
+
+    std::unique_ptr<RaptorRouter> TransportRouter::CreateRaptor(const catalogue::TransportCatalogue& catalogue) const {
+        return std::make_unique<RaptorRouter>(catalogue, routing_settings_.bus_wait_time,
+                                              routing_settings_.bus_velocity * KM_TO_METERS / MINUTES_IN_HOUR);
+    }
+
+    graph::DirectedWeightedGraph<double> TransportRouter::BuildGraph(const catalogue::TransportCatalogue& catalogue) {
+        if (routing_settings_.graph_model == GraphModel::LINEAR) {
+            return BuildLinearGraph(catalogue);
+        }
+        vertex_stops_.resize(catalogue.GetStopCount());
+        for (size_t stop_index = 0; stop_index < vertex_stops_.size(); ++stop_index) {
+            vertex_stops_[stop_index] = stop_index;
+        }
+
+        std::vector<const domain::Bus*> buses;
+        for (const auto& [_, bus] : catalogue.GetAllBuses()) {
+            buses.push_back(bus);
+        }
+
+        // Рёбра каждого автобуса строятся независимо, а добавляются в граф в исходном
+        // порядке, поэтому нумерация рёбер не зависит от числа потоков
+        std::vector<std::vector<graph::Edge<double>>> bus_edges(buses.size());
+        const size_t thread_count = parallel::ResolveThreadCount(routing_settings_.precompute_threads, buses.size());
+        parallel::RunInThreads(thread_count, [&](size_t thread_index) {
+            for (size_t i = thread_index; i < buses.size(); i += thread_count) {
+                bus_edges[i] = BuildBusEdges(*buses[i]);
+            }
+        });
+
+        graph::DirectedWeightedGraph<double> graph(catalogue.GetStopCount());
+        for (const auto& edges : bus_edges) {
+            for (const auto& edge : edges) {
+                graph.AddEdge(edge);
+            }
+        }
         return graph;
     }
+
+    std::vector<graph::Edge<double>> TransportRouter::BuildBusEdges(const domain::Bus& bus) const {
+        if (bus.stops.size() > std::numeric_limits<uint16_t>::max()) {
+            throw std::length_error("Too many stops in bus " + std::string(bus.name));
+        }
+        std::vector<graph::Edge<double>> edges;
+        const auto& stops = bus.stops;
+        for (size_t i = 0; i < stops.size(); ++i) {
+            uint16_t stop_count = 0;
+            for (size_t j = i + 1; j < stops.size(); ++j) {
+                const double distance = bus.road_distances[j] - bus.road_distances[i];
+                double travel_time = ComputeTravelTime(distance);
+                ++stop_count;
+                edges.push_back({
+                    stops[i],
+                    stops[j],
+                    routing_settings_.bus_wait_time + travel_time,
+                    bus.id,
+                    stop_count
+                });
+            }
+        }
+        return edges;
+    }
+
+    graph::DirectedWeightedGraph<double> TransportRouter::BuildLinearGraph(const catalogue::TransportCatalogue& catalogue) {
+        const size_t stop_count = catalogue.GetStopCount();
+        vertex_stops_.resize(stop_count);
+        for (size_t stop_index = 0; stop_index < stop_count; ++stop_index) {
+            vertex_stops_[stop_index] = stop_index;
+        }
+
+        graph::DirectedWeightedGraph<double> graph(stop_count);
+        bus_ride_vertices_.clear();
+        free_ride_vertices_.clear();
+        for (const auto& [_, bus] : catalogue.GetAllBuses()) {
+            AddLinearBusEdges(graph, *bus);
+        }
+        return graph;
+    }
+
+    std::vector<graph::EdgeId> TransportRouter::AddLinearBusEdges(graph::DirectedWeightedGraph<double>& graph,
+                                                                  const domain::Bus& bus) {
+        const graph::VertexId first_ride_vertex = AllocateRideVertices(graph, bus);
+        for (size_t i = 0; i < bus.stops.size(); ++i) {
+            vertex_stops_[first_ride_vertex + i] = bus.stops[i];
+        }
+
+        std::vector<graph::EdgeId> edge_ids;
+        for (const auto& edge : BuildLinearBusEdges(bus, first_ride_vertex)) {
+            edge_ids.push_back(graph.AddEdge(edge));
+        }
+        return edge_ids;
+    }
+
+    graph::VertexId TransportRouter::AllocateRideVertices(graph::DirectedWeightedGraph<double>& graph,
+                                                          const domain::Bus& bus) {
+        const size_t count = bus.stops.size();
+        if (auto it = bus_ride_vertices_.find(bus.name); it != bus_ride_vertices_.end()) {
+            if (it->second.count >= count) {
+                return it->second.first;
+            }
+            ReleaseRideVertices(bus.name);
+        }
+        RideVertexRange range{graph.GetVertexCount(), count};
+        const auto free_it = std::find_if(free_ride_vertices_.begin(), free_ride_vertices_.end(),
+                                          [count](const RideVertexRange& free_range) {
+                                              return free_range.count >= count;
+                                          });
+        if (free_it != free_ride_vertices_.end()) {
+            range.first = free_it->first;
+            free_it->first += count;
+            free_it->count -= count;
+            if (free_it->count == 0) {
+                free_ride_vertices_.erase(free_it);
+            }
+        } else {
+            graph.AddVertices(count);
+            vertex_stops_.resize(graph.GetVertexCount());
+        }
+        bus_ride_vertices_[bus.name] = range;
+        return range.first;
+    }
+
+    void TransportRouter::ReleaseRideVertices(std::string_view bus_name) {
+        if (auto it = bus_ride_vertices_.find(bus_name); it != bus_ride_vertices_.end()) {
+            if (it->second.count > 0) {
+                free_ride_vertices_.push_back(it->second);
+            }
+            bus_ride_vertices_.erase(it);
+        }
+    }
+
+    void TransportRouter::IndexRideVertices() {
+        bus_ride_vertices_.clear();
+        free_ride_vertices_.clear();
+        if (routing_settings_.graph_model != GraphModel::LINEAR) {
+            return;
+        }
+        for (const auto& [bus_name, edge_ids] : bus_edges_) {
+            // У каждого ребра линейной модели хотя бы один конец — вершина поездки
+            graph::VertexId first = std::numeric_limits<graph::VertexId>::max();
+            graph::VertexId last = 0;
+            for (const graph::EdgeId edge_id : edge_ids) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const graph::VertexId ride_vertex = IsStopVertex(edge.from) ? edge.to : edge.from;
+                first = std::min(first, ride_vertex);
+                last = std::max(last, ride_vertex);
+            }
+            bus_ride_vertices_[bus_name] = {first, last - first + 1};
+        }
+    }
+
+    void TransportRouter::RebuildGraph(const catalogue::TransportCatalogue& catalogue) {
+        graph_ = BuildGraph(catalogue);
+        graph_.Freeze();
+        IndexBusEdges(catalogue);
+        router_ = CreateEngine(catalogue);
+        ++engine_rebuild_count_;
+    }
+
+    std::vector<graph::Edge<double>> TransportRouter::BuildLinearBusEdges(const domain::Bus& bus,
+                                                                        graph::VertexId first_ride_vertex) const {
+        const auto& stops = bus.stops;
+        const domain::BusId bus_id = bus.id;
+        std::vector<graph::Edge<double>> edges;
+        for (size_t i = 0; i < stops.size(); ++i) {
+            const graph::CompactVertexId stop_vertex = stops[i];
+            const auto ride_vertex = static_cast<graph::CompactVertexId>(first_ride_vertex + i);
+            if (i + 1 < stops.size()) {
+                edges.push_back({stop_vertex, ride_vertex, static_cast<double>(routing_settings_.bus_wait_time), bus_id, 0});
+                const double distance = bus.road_distances[i + 1] - bus.road_distances[i];
+                edges.push_back({ride_vertex, ride_vertex + 1, ComputeTravelTime(distance), bus_id, 1});
+            }
+            if (i > 0) {
+                edges.push_back({ride_vertex, stop_vertex, 0.0, bus_id, 0});
+            }
+        }
+        return edges;
+    }
+
+    void TransportRouter::ReplaceChangedEdges(const std::vector<graph::EdgeId>& old_edge_ids,
+                                              std::vector<graph::Edge<double>> new_edges,
+                                              std::vector<graph::EdgeId>& added_edge_ids) {
+        const auto edge_key = [](const graph::Edge<double>& edge) {
+            return std::tuple(edge.from, edge.to, edge.span_count, edge.weight);
+        };
+        std::vector<graph::EdgeId> old_ids = old_edge_ids;
+        std::sort(old_ids.begin(), old_ids.end(), [&](graph::EdgeId lhs, graph::EdgeId rhs) {
+            return edge_key(graph_.GetEdge(lhs)) < edge_key(graph_.GetEdge(rhs));
+        });
+        std::sort(new_edges.begin(), new_edges.end(), [&](const auto& lhs, const auto& rhs) {
+            return edge_key(lhs) < edge_key(rhs);
+        });
+
+        // Слияние двух упорядоченных списков: совпадающие рёбра остаются на месте
+        size_t old_index = 0;
+        size_t new_index = 0;
+        while (old_index < old_ids.size() || new_index < new_edges.size()) {
+            if (new_index == new_edges.size()
+                || (old_index < old_ids.size() && edge_key(graph_.GetEdge(old_ids[old_index])) < edge_key(new_edges[new_index]))) {
+                graph_.RemoveEdge(old_ids[old_index++]);
+            } else if (old_index == old_ids.size()
+                       || edge_key(new_edges[new_index]) < edge_key(graph_.GetEdge(old_ids[old_index]))) {
+                added_edge_ids.push_back(graph_.AddEdge(new_edges[new_index++]));
+            } else {
+                ++old_index;
+                ++new_index;
+            }
+        }
+    }
+
+    void TransportRouter::IndexBusEdges(const catalogue::TransportCatalogue& catalogue) {
+        bus_edges_.clear();
+        for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            bus_edges_[catalogue.GetBusToIndex(graph_.GetEdge(edge_id).bus_id)].push_back(edge_id);
+        }
+    }
+
+    void TransportRouter::OnStopAdded(const domain::Stop&) {
+        ++added_stop_count_;
+    }
+
+    void TransportRouter::OnDistanceChanged(const domain::Stop& from, const domain::Stop& to) {
+        // Расстояние from → to используется и для обратного перегона, если тот не задан
+        changed_segments_.emplace(from.id, to.id);
+        changed_segments_.emplace(to.id, from.id);
+    }
+
+    void TransportRouter::OnBusAdded(const domain::Bus& bus) {
+        changed_buses_.insert(bus.name);
+    }
+
+    void TransportRouter::OnBusRemoved(const domain::Bus& bus) {
+        changed_buses_.insert(bus.name);
+    }
+
+    void TransportRouter::ApplyChanges(const catalogue::TransportCatalogue& catalogue) {
+        if (added_stop_count_ == 0 && changed_buses_.empty() && changed_segments_.empty()) {
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        route_cache_.Clear();
+        // Индекс маршрутов RAPTOR строится за один проход по автобусам, дешевле перестроить его целиком
+        if (raptor_) {
+            added_stop_count_ = 0;
+            changed_buses_.clear();
+            changed_segments_.clear();
+            raptor_ = CreateRaptor(catalogue);
+            ++engine_rebuild_count_;
+            ++update_count_;
+            update_time_ += std::chrono::steady_clock::now() - start;
+            return;
+        }
+
+        // Автобусы, у которых изменился состав остановок, и автобусы, у которых
+        // изменилась только длина перегонов
+        const std::set<std::string_view> rebuilt_buses = std::move(changed_buses_);
+        std::set<std::string_view> reweighted_buses;
+        if (!changed_segments_.empty()) {
+            for (const auto& [bus_name, bus] : catalogue.GetAllBuses()) {
+                for (size_t i = 0; i + 1 < bus->stops.size(); ++i) {
+                    if (changed_segments_.count({bus->stops[i], bus->stops[i + 1]}) > 0) {
+                        if (rebuilt_buses.count(bus_name) == 0) {
+                            reweighted_buses.insert(bus_name);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        const size_t added_stop_count = added_stop_count_;
+        added_stop_count_ = 0;
+        changed_buses_.clear();
+        changed_segments_.clear();
+
+        // В линейной модели вершины остановок предшествуют вершинам поездки,
+        // поэтому новая остановка сдвигает нумерацию: граф строится заново
+        if (routing_settings_.graph_model == GraphModel::LINEAR && added_stop_count > 0) {
+            RebuildGraph(catalogue);
+            ++update_count_;
+            update_time_ += std::chrono::steady_clock::now() - start;
+            return;
+        }
+
+        graph::GraphUpdate<double> update;
+        update.old_vertex_count = graph_.GetVertexCount();
+        std::vector<graph::EdgeId> added_edges;
+        for (const std::string_view bus_name : reweighted_buses) {
+            const domain::Bus& bus = *catalogue.FindBus(bus_name);
+            auto new_edges = routing_settings_.graph_model == GraphModel::LINEAR
+                ? BuildLinearBusEdges(bus, bus_ride_vertices_.at(bus_name).first)
+                : BuildBusEdges(bus);
+            // У автобуса с изменённым перегоном не меньше двух остановок, значит, есть и рёбра
+            ReplaceChangedEdges(bus_edges_.at(bus_name), std::move(new_edges), added_edges);
+        }
+
+        for (const std::string_view bus_name : rebuilt_buses) {
+            if (auto it = bus_edges_.find(bus_name); it != bus_edges_.end()) {
+                for (const graph::EdgeId edge_id : it->second) {
+                    graph_.RemoveEdge(edge_id);
+                }
+            }
+        }
+        if (added_stop_count > 0) {
+            graph_.AddVertices(added_stop_count);
+            for (size_t vertex = vertex_stops_.size(); vertex < graph_.GetVertexCount(); ++vertex) {
+                vertex_stops_.push_back(vertex);
+            }
+        }
+        for (const std::string_view bus_name : rebuilt_buses) {
+            const domain::Bus* bus = catalogue.FindBus(bus_name);
+            if (bus == nullptr) {
+                ReleaseRideVertices(bus_name);
+                continue;
+            }
+            if (routing_settings_.graph_model == GraphModel::LINEAR) {
+                const auto edge_ids = AddLinearBusEdges(graph_, *bus);
+                added_edges.insert(added_edges.end(), edge_ids.begin(), edge_ids.end());
+            } else {
+                for (const auto& edge : BuildBusEdges(*bus)) {
+                    added_edges.push_back(graph_.AddEdge(edge));
+                }
+            }
+        }
+
+        // Вершины поездки переиспользуются, но свободные диапазоны могут не подойти по длине.
+        // Когда неиспользуемых вершин становится больше, чем используемых, граф строится заново,
+        // так что вершин всегда не больше 2 × (остановки + сумма длин маршрутов)
+        if (routing_settings_.graph_model == GraphModel::LINEAR) {
+            size_t used_vertex_count = catalogue.GetStopCount();
+            for (const auto& [_, bus] : catalogue.GetAllBuses()) {
+                used_vertex_count += bus->stops.size();
+            }
+            if (graph_.GetVertexCount() > 2 * used_vertex_count) {
+                RebuildGraph(catalogue);
+                ++update_count_;
+                update_time_ += std::chrono::steady_clock::now() - start;
+                return;
+            }
+        }
+
+        update.new_edge_ids = graph_.Freeze();
+        for (const graph::EdgeId edge_id : added_edges) {
+            update.added_edges.push_back(update.new_edge_ids[edge_id]);
+        }
+        IndexBusEdges(catalogue);
+        if (!router_->ApplyUpdate(update)) {
+            router_ = CreateEngine(catalogue);
+            ++engine_rebuild_count_;
+        }
+        ++update_count_;
+        update_time_ += std::chrono::steady_clock::now() - start;
+    }
+
+    double TransportRouter::ComputeTravelTime(double distance) const {
+        return distance / (routing_settings_.bus_velocity * KM_TO_METERS / MINUTES_IN_HOUR);
+    }
+
+    double TransportRouter::ComputeWalkTime(double distance) const {
+        return distance / (routing_settings_.walk_velocity * KM_TO_METERS / MINUTES_IN_HOUR);
+    }
+
+    std::optional<WalkInfo> TransportRouter::MakeWalk(double distance) const {
+        if (distance <= 0.0) {
+            return std::nullopt;
+        }
+        return WalkInfo{distance, ComputeWalkTime(distance)};
+    }
+
+    bool TransportRouter::IsStopVertex(graph::VertexId vertex) const {
+        return vertex < vertex_stops_.size() && vertex_stops_[vertex] == vertex;
+    }
+
+    std::vector<RideInfo> TransportRouter::CollapseLinearRoute(const std::vector<graph::EdgeId>& edge_ids,
+                                                               const catalogue::TransportCatalogue& catalogue) const {
+        std::vector<RideInfo> rides;
+        std::optional<RideInfo> current_ride;
+        for (const graph::EdgeId edge_id : edge_ids) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (IsStopVertex(edge.from)) {
+                // Посадка: ожидание на остановке
+                current_ride = RideInfo{edge.from, edge.from, edge.weight, catalogue.GetBusToIndex(edge.bus_id), 0};
+            } else if (IsStopVertex(edge.to)) {
+                // Высадка завершает поездку
+                if (!current_ride) {
+                    throw std::logic_error("Route leaves a bus it has not boarded");
+                }
+                current_ride->to = edge.to;
+                rides.push_back(*current_ride);
+                current_ride.reset();
+            } else if (current_ride) {
+                current_ride->time += edge.weight;
+                current_ride->span_count += edge.span_count;
+            }
+        }
+        return rides;
+    }
+
+    bool TransportRouter::LoadFromFile(const RouterFileSettings& file_settings,
+                                       const catalogue::TransportCatalogue& catalogue) {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            route_file_ = std::make_unique<io::MappedFile>(file_settings.path);
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+        const io::MappedFile& file = *route_file_;
+
+        RouterFileHeader header;
+        if (file.GetSize() < sizeof(header)) {
+            route_file_.reset();
+            return false;
+        }
+        std::memcpy(&header, file.GetData(), sizeof(header));
+        const bool needs_table = routing_settings_.engine == RouterEngine::ALL_PAIRS;
+        const size_t stop_count = catalogue.GetStopCount();
+        const size_t bus_count = catalogue.GetAllBuses().size();
+        const bool header_matches =
+            std::memcmp(header.magic, ROUTER_FILE_MAGIC, sizeof(ROUTER_FILE_MAGIC)) == 0
+            && header.version == ROUTER_FILE_VERSION
+            && header.byte_order_mark == BYTE_ORDER_MARK
+            && header.key == file_settings.key
+            && header.file_size == file.GetSize()
+            && header.graph_model == static_cast<uint32_t>(routing_settings_.graph_model)
+            && header.table_weight == (needs_table ? static_cast<uint32_t>(routing_settings_.table_weight) : NO_TABLE)
+            && header.vertex_count >= stop_count
+            && header.vertex_count < NO_TABLE
+            && header.edge_count < graph::RouteTable<double>::NO_EDGE;
+        const auto* edges = header_matches
+            ? GetSection<StoredEdge>(file, header.edges_offset, header.edge_count) : nullptr;
+        const auto* vertex_stops = header_matches
+            ? GetSection<uint64_t>(file, header.vertex_stops_offset, header.vertex_count) : nullptr;
+        if (edges == nullptr || vertex_stops == nullptr) {
+            route_file_.reset();
+            return false;
+        }
+
+        // В файле автобус задан позицией в GetAllBuses, в графе — индексом в каталоге
+        std::vector<uint32_t> bus_ids;
+        bus_ids.reserve(bus_count);
+        for (const auto& [bus_name, _] : catalogue.GetAllBuses()) {
+            bus_ids.push_back(static_cast<uint32_t>(catalogue.FindBusIndex(bus_name)));
+        }
+
+        // Рёбра в файле уже упорядочены по начальной вершине, поэтому Freeze сохраняет их id,
+        // на которые ссылается таблица маршрутов
+        graph::DirectedWeightedGraph<double> graph(header.vertex_count);
+        for (uint64_t edge_id = 0; edge_id < header.edge_count; ++edge_id) {
+            const StoredEdge& edge = edges[edge_id];
+            if (edge.from >= header.vertex_count || edge.to >= header.vertex_count || edge.bus_index >= bus_count
+                || edge.span_count < 0 || edge.span_count > std::numeric_limits<uint16_t>::max()
+                || (edge_id > 0 && edge.from < edges[edge_id - 1].from)) {
+                route_file_.reset();
+                return false;
+            }
+            graph.AddEdge({static_cast<graph::CompactVertexId>(edge.from), static_cast<graph::CompactVertexId>(edge.to),
+                           edge.weight, bus_ids[edge.bus_index], static_cast<uint16_t>(edge.span_count)});
+        }
+        graph.Freeze();
+
+        std::vector<size_t> loaded_vertex_stops(vertex_stops, vertex_stops + header.vertex_count);
+        for (const size_t stop_index : loaded_vertex_stops) {
+            if (stop_index >= stop_count) {
+                route_file_.reset();
+                return false;
+            }
+        }
+        graph_build_time_ = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        graph_ = std::move(graph);
+        vertex_stops_ = std::move(loaded_vertex_stops);
+        IndexBusEdges(catalogue);
+        IndexRideVertices();
+        std::unique_ptr<graph::RoutingEngine<double>> engine;
+        if (!needs_table) {
+            engine = CreateEngine(catalogue);
+        } else {
+            switch (routing_settings_.table_weight) {
+                case TableWeight::FLOAT:
+                    engine = MakeMappedRouter<float>(graph_, file, header);
+                    break;
+                case TableWeight::FIXED_POINT:
+                    engine = MakeMappedRouter<uint32_t>(graph_, file, header);
+                    break;
+                case TableWeight::DOUBLE:
+                    engine = MakeMappedRouter<double>(graph_, file, header);
+                    break;
+            }
+            if (!engine) {
+                graph_ = {};
+                route_file_.reset();
+                return false;
+            }
+        }
+        router_ = std::move(engine);
+        engine_build_time_ = std::chrono::steady_clock::now() - start;
+        return true;
+    }
+
+    void TransportRouter::SaveToFile(const RouterFileSettings& file_settings,
+                                     const catalogue::TransportCatalogue& catalogue) const {
+        std::unordered_map<size_t, uint32_t> bus_indices;
+        for (const auto& [bus_name, _] : catalogue.GetAllBuses()) {
+            bus_indices.emplace(catalogue.FindBusIndex(bus_name), static_cast<uint32_t>(bus_indices.size()));
+        }
+
+        const bool has_table = routing_settings_.engine == RouterEngine::ALL_PAIRS;
+        RouterFileHeader header{};
+        std::memcpy(header.magic, ROUTER_FILE_MAGIC, sizeof(ROUTER_FILE_MAGIC));
+        header.version = ROUTER_FILE_VERSION;
+        header.byte_order_mark = BYTE_ORDER_MARK;
+        header.key = file_settings.key;
+        header.vertex_count = graph_.GetVertexCount();
+        header.edge_count = graph_.GetEdgeCount();
+        header.table_weight = has_table ? static_cast<uint32_t>(routing_settings_.table_weight) : NO_TABLE;
+        header.graph_model = static_cast<uint32_t>(routing_settings_.graph_model);
+        header.edges_offset = AlignSection(sizeof(header));
+        header.vertex_stops_offset = AlignSection(header.edges_offset + header.edge_count * sizeof(StoredEdge));
+        header.file_size = header.vertex_stops_offset + header.vertex_count * sizeof(uint64_t);
+        if (has_table) {
+            const uint64_t cell_count = header.vertex_count * header.vertex_count;
+            header.table_weights_offset = AlignSection(header.file_size);
+            header.table_prev_edges_offset = AlignSection(
+                header.table_weights_offset + cell_count * GetStoredWeightSize(routing_settings_.table_weight));
+            header.file_size = header.table_prev_edges_offset + cell_count * sizeof(CompactEdgeId);
+        }
+
+        io::WriteFileAtomically(file_settings.path, [&](std::ostream& output) {
+            SectionWriter writer(output);
+            writer.Write(&header, sizeof(header));
+
+            writer.PadTo(header.edges_offset);
+            for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const StoredEdge stored_edge{edge.from, edge.to, edge.weight,
+                                             bus_indices.at(edge.bus_id), edge.span_count};
+                writer.Write(&stored_edge, sizeof(stored_edge));
+            }
+
+            writer.PadTo(header.vertex_stops_offset);
+            for (const size_t stop_index : vertex_stops_) {
+                const uint64_t stored_stop_index = stop_index;
+                writer.Write(&stored_stop_index, sizeof(stored_stop_index));
+            }
+
+            if (!has_table) {
+                return;
+            }
+            switch (routing_settings_.table_weight) {
+                case TableWeight::FLOAT:
+                    WriteRouteTable<float>(writer, *router_, header);
+                    break;
+                case TableWeight::FIXED_POINT:
+                    WriteRouteTable<uint32_t>(writer, *router_, header);
+                    break;
+                case TableWeight::DOUBLE:
+                    WriteRouteTable<double>(writer, *router_, header);
+                    break;
+            }
+        });
+    }
 }
\ No newline at end of file
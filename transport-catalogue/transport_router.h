@@ -1,10 +1,29 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <iostream>
 #include <memory>
 #include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "astar_router.h"
+#include "ch_router.h"
+#include "dijkstra_router.h"
+#include "flat_hash_map.h"
 #include "graph.h"
+#include "lru_cache.h"
+#include "mapped_file.h"
+#include "raptor_router.h"
+#include "route_info.h"
 #include "router.h"
+#include "shortest_path_tree.h"
+#include "spatial_index.h"
 #include "transport_catalogue.h"
 
 namespace router {
@@ -12,32 +31,209 @@ namespace router {
 static constexpr double KM_TO_METERS = 1000.0;
 static constexpr double MINUTES_IN_HOUR = 60.0;    
     
+enum class RouterEngine {
+    ALL_PAIRS,
+    DIJKSTRA,
+    CONTRACTION_HIERARCHY,
+    // Поиск по требованию с оценкой по расстоянию по прямой
+    ASTAR,
+    BIDIRECTIONAL_ASTAR,
+    // Поиск по раундам прямо по маршрутам автобусов, без графа; умеет строить альтернативы
+    RAPTOR,
+};
+
+// Модель графа маршрутов
+enum class GraphModel {
+    // Вершины — остановки, ребро из каждой остановки в каждую следующую по автобусу: O(L²)
+    COMPLETE,
+    // Вершина ожидания на остановке и вершина поездки на каждую позицию автобуса;
+    // рёбра посадки, перегона и высадки: O(L)
+    LINEAR,
+};
+
+// Тип веса в таблице маршрутов движка ALL_PAIRS
+enum class TableWeight {
+    DOUBLE,
+    FLOAT,
+    FIXED_POINT,
+};
+
 struct RoutingSettings {
     int bus_wait_time = 0;
     double bus_velocity = 0.0;
+    RouterEngine engine = RouterEngine::ALL_PAIRS;
+    GraphModel graph_model = GraphModel::COMPLETE;
+    graph::HeapType heap_type = graph::HeapType::BINARY;
+    TableWeight table_weight = TableWeight::DOUBLE;
+    graph::RelaxKernel relax_kernel = graph::RelaxKernel::CLASSIC;
+    // Число потоков для построения графа и предрасчёта; 0 — по числу ядер
+    size_t precompute_threads = 1;
+    // Число готовых маршрутов в LRU-кэше; 0 — кэш выключен
+    size_t route_cache_size = 0;
+    // Скорость пешехода в км/ч и наибольшая длина пешего участка в метрах для маршрутов между точками
+    double walk_velocity = 5.0;
+    double walk_radius = 1000.0;
+    bool log_stats = false;
 };
     
-struct RouteInfo {
-    double full_time = 0.0;
-    std::vector<graph::Edge<double>> edges;
-};    
+// Файл с сохранённым графом и таблицей маршрутов для быстрого перезапуска
+struct RouterFileSettings {
+    std::string path;
+    // Хеш исходных данных и настроек маршрутизации: файл с другим ключом строится заново
+    uint64_t key = 0;
+};
+
+
+// Остановка, достижимая за отведённое время
+struct ReachableStop {
+    size_t stop_index = 0;
+    double time = 0.0;
+};
+
+// Пара вершин собирается в одно 64-битное число и перемешивается, как ключи FlatHashMap:
+// у плотных номеров вершин линейная комбинация хешей даёт много совпадений
+struct HashVertexPair {
+    size_t operator()(const std::pair<graph::VertexId, graph::VertexId>& stops) const {
+        return static_cast<size_t>(containers::MixHash((static_cast<uint64_t>(stops.first) << 32) ^ stops.second));
+    }
+};
 
-class TransportRouter {
+// Изменения каталога накапливаются через CatalogueObserver и применяются к графу
+// и движку вызовом ApplyChanges
+class TransportRouter final : public catalogue::CatalogueObserver {
 public:
     TransportRouter() = default;
 
-    TransportRouter(const catalogue::TransportCatalogue& catalogue, RoutingSettings settings);
+    // Если задан file_settings, граф и таблица маршрутов загружаются из файла
+    // с подходящим ключом, а при его отсутствии строятся и сохраняются в файл
+    TransportRouter(const catalogue::TransportCatalogue& catalogue, RoutingSettings settings,
+                    std::optional<RouterFileSettings> file_settings = std::nullopt);
 
     const RoutingSettings& GetRoutingSettings() const;
 
     const std::optional<RouteInfo> BuildRoute (const std::string& from, const std::string& to, const catalogue::TransportCatalogue& catalogue) const ;
 
+    // Маршруты из одной остановки в каждую из targets в том же порядке. Движки dijkstra,
+    // astar и contraction_hierarchy строят для пакета одно дерево кратчайших путей.
+    std::vector<std::optional<RouteInfo>> BuildRoutes(const std::string& from, const std::vector<std::string>& targets,
+                                                      const catalogue::TransportCatalogue& catalogue) const;
+
+    // Маршруты, оптимальные по Парето по числу пересадок и времени, от самого короткого
+    // по пересадкам к самому быстрому. Кроме raptor, движки возвращают только быстрейший маршрут.
+    std::vector<RouteInfo> BuildAlternatives(const std::string& from, const std::string& to,
+                                             const catalogue::TransportCatalogue& catalogue) const;
+
+    // Времена в пути для всех пар sources × targets построчно; nullopt — маршрута нет.
+    // Пути не восстанавливаются: all_pairs читает таблицу, ch ищет «многие ко многим»
+    // с корзинами, остальные движки строят по дереву на источник.
+    std::vector<std::optional<double>> BuildTimeMatrix(const std::vector<std::string>& sources, const std::vector<std::string>& targets,
+                                                       const catalogue::TransportCatalogue& catalogue) const;
+
+    // Остановки, до которых из from можно добраться не дольше чем за max_time минут,
+    // в порядке неубывания времени; считается одним проходом Дейкстры, ограниченным max_time
+    std::vector<ReachableStop> FindReachableStops(const std::string& from, double max_time,
+                                                  const catalogue::TransportCatalogue& catalogue) const;
+
+    // Быстрейший маршрут между точками. from_stops и to_stops — остановки в пешей доступности
+    // от начала и конца маршрута с расстояниями до них, direct_distance — расстояние между точками,
+    // если его можно пройти пешком целиком. Все пары остановок покрывает один поиск: графовые движки
+    // запускают Дейкстру по графу сразу из всех начальных остановок, raptor — поиск по раундам
+    std::optional<PointRouteInfo> BuildPointRoute(const std::vector<spatial::NearbyStop>& from_stops,
+                                                  const std::vector<spatial::NearbyStop>& to_stops,
+                                                  std::optional<double> direct_distance,
+                                                  const catalogue::TransportCatalogue& catalogue) const;
+
+    // Выводит размеры графа и объём памяти движка маршрутизации
+    void ReportStats(std::ostream& output) const;
+
+    void OnStopAdded(const domain::Stop& stop) override;
+    void OnDistanceChanged(const domain::Stop& from, const domain::Stop& to) override;
+    void OnBusAdded(const domain::Bus& bus) override;
+    void OnBusRemoved(const domain::Bus& bus) override;
+
+    // Перестраивает рёбра затронутых автобусов и обновляет движок. Движки all_pairs
+    // и dijkstra обновляются частично, остальные строятся заново по изменённому графу.
+    void ApplyChanges(const catalogue::TransportCatalogue& catalogue);
+
 private:
     RoutingSettings routing_settings_;
     graph::DirectedWeightedGraph<double> graph_;
-    std::unique_ptr<graph::Router<double>> router_;
+    // Движок может ссылаться на память отображённого файла, поэтому файл объявлен раньше
+    std::unique_ptr<io::MappedFile> route_file_;
+    std::unique_ptr<graph::RoutingEngine<double>> router_;
+    // Вместо router_ и графа при движке raptor
+    std::unique_ptr<RaptorRouter> raptor_;
+    // off, loaded или saved
+    std::string_view route_file_status_ = "off";
+    std::chrono::duration<double, std::milli> graph_build_time_{};
+    std::chrono::duration<double, std::milli> engine_build_time_{};
+    mutable std::chrono::duration<double, std::milli> query_time_{};
+    mutable size_t query_count_ = 0;
+    // Готовые маршруты по паре (остановка отправления, остановка назначения); nullopt —
+    // маршрута нет. Сбрасывается при изменении графа.
+    mutable cache::LruCache<std::pair<graph::VertexId, graph::VertexId>, std::optional<RouteInfo>, HashVertexPair> route_cache_;
+    size_t update_count_ = 0;
+    size_t engine_rebuild_count_ = 0;
+    std::chrono::duration<double, std::milli> update_time_{};
+
+    // Остановке с индексом i соответствует вершина i; вершины поездки линейной модели
+    // идут следом, для них здесь хранится индекс остановки
+    std::vector<size_t> vertex_stops_;
+    // Рёбра графа каждого автобуса
+    std::unordered_map<std::string_view, std::vector<graph::EdgeId>> bus_edges_;
+    // Вершины поездки first..first + count - 1 в линейной модели
+    struct RideVertexRange {
+        graph::VertexId first = 0;
+        size_t count = 0;
+    };
+    // Вершины поездки каждого автобуса; автобус может занимать больше вершин, чем у него остановок
+    std::unordered_map<std::string_view, RideVertexRange> bus_ride_vertices_;
+    // Вершины поездки удалённых автобусов и автобусов, переехавших в больший диапазон
+    std::vector<RideVertexRange> free_ride_vertices_;
+
+    // Ещё не применённые изменения каталога
+    size_t added_stop_count_ = 0;
+    std::set<std::string_view> changed_buses_;
+    std::set<std::pair<domain::StopId, domain::StopId>> changed_segments_;
+
+    graph::DirectedWeightedGraph<double> BuildGraph(const catalogue::TransportCatalogue& catalogue);
+    graph::DirectedWeightedGraph<double> BuildLinearGraph(const catalogue::TransportCatalogue& catalogue);
+    // Добавляет рёбра автобуса на его вершинах поездки, возвращает id рёбер
+    std::vector<graph::EdgeId> AddLinearBusEdges(graph::DirectedWeightedGraph<double>& graph, const domain::Bus& bus);
+    // Первая вершина поездки автобуса: прежний диапазон автобуса, если в нём хватает места,
+    // затем подходящий свободный, иначе новые вершины в конце графа
+    graph::VertexId AllocateRideVertices(graph::DirectedWeightedGraph<double>& graph, const domain::Bus& bus);
+    void ReleaseRideVertices(std::string_view bus_name);
+    // Диапазоны вершин поездки по рёбрам загруженного из файла графа
+    void IndexRideVertices();
+    // Граф строится заново без неиспользуемых вершин поездки, движок — по новому графу
+    void RebuildGraph(const catalogue::TransportCatalogue& catalogue);
+    std::vector<graph::Edge<double>> BuildLinearBusEdges(const domain::Bus& bus, graph::VertexId first_ride_vertex) const;
+    // Удаляет из old_edge_ids рёбра, которых нет среди new_edges, и добавляет недостающие
+    void ReplaceChangedEdges(const std::vector<graph::EdgeId>& old_edge_ids, std::vector<graph::Edge<double>> new_edges,
+                             std::vector<graph::EdgeId>& added_edge_ids);
+    void IndexBusEdges(const catalogue::TransportCatalogue& catalogue);
+    std::vector<graph::Edge<double>> BuildBusEdges(const domain::Bus& bus) const;
+    double ComputeTravelTime(double distance) const;
+    double ComputeWalkTime(double distance) const;
+    // Пеший участок; nullopt, если идти не нужно
+    std::optional<WalkInfo> MakeWalk(double distance) const;
+    RouteInfo MakeRouteInfo(const graph::RoutingEngine<double>::RouteInfo& route,
+                            const catalogue::TransportCatalogue& catalogue) const;
+    bool IsStopVertex(graph::VertexId vertex) const;
+    // Сворачивает рёбра посадки, перегонов и высадки линейной модели в рёбра вида «остановка → остановка»
+    std::vector<RideInfo> CollapseLinearRoute(const std::vector<graph::EdgeId>& edge_ids,
+                                              const catalogue::TransportCatalogue& catalogue) const;
+    std::unique_ptr<graph::RoutingEngine<double>> CreateEngine(const catalogue::TransportCatalogue& catalogue) const;
+    std::unique_ptr<RaptorRouter> CreateRaptor(const catalogue::TransportCatalogue& catalogue) const;
+    // Наименьшее отношение дорожного расстояния к расстоянию по прямой (не больше 1)
+    double ComputeLowerBoundScale(const catalogue::TransportCatalogue& catalogue) const;
+    // Допустимая оценка времени в пути между вершинами для A*
+    graph::LowerBound<double> CreateLowerBound(const catalogue::TransportCatalogue& catalogue) const;
 
-    graph::DirectedWeightedGraph<double> BuildGraph(const catalogue::TransportCatalogue& catalogue) const;
+    // Возвращает false, если файла нет или он не подходит к текущим данным
+    bool LoadFromFile(const RouterFileSettings& file_settings, const catalogue::TransportCatalogue& catalogue);
+    void SaveToFile(const RouterFileSettings& file_settings, const catalogue::TransportCatalogue& catalogue) const;
 };
 
 }
\ No newline at end of file